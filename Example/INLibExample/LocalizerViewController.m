@@ -33,6 +33,13 @@
 
 @implementation LocalizerViewController
 
+- (void)viewDidLoad {
+    [super viewDidLoad];
+    
+    // load the languages in the background, so switching them is instant
+    [INLocalizer preloadLanguages:@[@"en", @"fr", @"de"] completion:nil];
+}
+
 - (IBAction)btnEnglishPressed {
     [self updateLanguage:@"en"];
 }
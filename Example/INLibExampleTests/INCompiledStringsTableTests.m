@@ -0,0 +1,81 @@
+//
+//  INCompiledStringsTableTests.m
+//  INLibExample
+//
+
+#import <UIKit/UIKit.h>
+#import <XCTest/XCTest.h>
+
+@interface INCompiledStringsTableTests : XCTestCase
+
+@property (nonatomic, copy) NSString *path;
+
+@end
+
+@implementation INCompiledStringsTableTests
+
+- (void)setUp {
+    [super setUp];
+    self.path = [NSTemporaryDirectory() stringByAppendingPathComponent:@"INCompiledStringsTableTests.inlstrings"];
+}
+
+- (void)tearDown {
+    [[NSFileManager defaultManager] removeItemAtPath:self.path error:NULL];
+    [super tearDown];
+}
+
+- (INCompiledStringsTable *)tableWithDictionary:(NSDictionary *)dictionary {
+    NSData *data = [INCompiledStringsTable compiledDataWithDictionary:dictionary];
+    [data writeToFile:self.path atomically:YES];
+    return [INCompiledStringsTable tableWithContentsOfFile:self.path];
+}
+
+
+#pragma mark - lookup
+
+- (void)test_objectForKey_onCompiledDictionary_returnsAllValues {
+    NSDictionary *dictionary = @{@"HelloWorld": @"Hallo Welt", @"Über": @"Über uns", @"a": @"b", @"": @"empty", @"ab": @"ba"};
+    INCompiledStringsTable *table = [self tableWithDictionary:dictionary];
+    XCTAssertNotNil(table, @"Table could not be loaded");
+    XCTAssertEqual(table.count, dictionary.count, @"Wrong number of entries");
+    for (NSString *key in dictionary) {
+        NSString *expect = dictionary[key];
+        NSString *result = table[key];
+        XCTAssert([result isEqualToString:expect], @"'%@' was expected, but is '%@'", expect, result);
+    }
+}
+
+- (void)test_objectForKey_onMissingKey_returnsNil {
+    INCompiledStringsTable *table = [self tableWithDictionary:@{@"b": @"c"}];
+    XCTAssertNil(table[@"a"], @"Missing key returned a value");
+    XCTAssertNil(table[@"c"], @"Missing key returned a value");
+    XCTAssertNil(table[nil], @"Nil key returned a value");
+}
+
+- (void)test_objectForKey_onLongKey_returnsValue {
+    NSString *key = [@"" stringByPaddingToLength:1000 withString:@"long key " startingAtIndex:0];
+    INCompiledStringsTable *table = [self tableWithDictionary:@{key: @"value"}];
+    NSString *result = table[key];
+    XCTAssert([result isEqualToString:@"value"], @"'value' was expected, but is '%@'", result);
+}
+
+
+#pragma mark - dictionaryRepresentation
+
+- (void)test_dictionaryRepresentation_returnsCompiledDictionary {
+    NSDictionary *dictionary = @{@"one": @"eins", @"two": @"zwei"};
+    INCompiledStringsTable *table = [self tableWithDictionary:dictionary];
+    XCTAssertEqualObjects([table dictionaryRepresentation], dictionary, @"Dictionary representation differs");
+}
+
+
+#pragma mark - invalid files
+
+- (void)test_tableWithContentsOfFile_onInvalidFile_returnsNil {
+    [[@"\"a\" = \"b\";" dataUsingEncoding:NSUTF8StringEncoding] writeToFile:self.path atomically:YES];
+    XCTAssertNil([INCompiledStringsTable tableWithContentsOfFile:self.path], @"Strings file was accepted as compiled table");
+    XCTAssertNil([INCompiledStringsTable tableWithContentsOfFile:[self.path stringByAppendingString:@"missing"]], @"Missing file returned a table");
+}
+
+
+@end
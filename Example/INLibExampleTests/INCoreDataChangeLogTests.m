@@ -0,0 +1,157 @@
+//
+//  INCoreDataChangeLogTests.m
+//  INLibExample
+//
+
+#import <UIKit/UIKit.h>
+#import <XCTest/XCTest.h>
+#import <CoreData/CoreData.h>
+#import <fcntl.h>
+#import <unistd.h>
+
+#import "INCoreData.h"
+
+@interface INCoreDataChangeLogTests : XCTestCase
+
+@property (nonatomic, strong) NSURL *url;
+@property (nonatomic, strong) NSManagedObjectContext *context;
+
+@end
+
+@implementation INCoreDataChangeLogTests
+
+- (void)setUp {
+    [super setUp];
+    self.url = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:@"INCoreDataChangeLogTests.changes"] isDirectory:NO];
+    [[NSFileManager defaultManager] removeItemAtURL:self.url error:NULL];
+
+    // an in-memory store with a single entity provides the object IDs to record
+    NSEntityDescription *entity = [[NSEntityDescription alloc] init];
+    entity.name = @"Item";
+    entity.managedObjectClassName = NSStringFromClass([NSManagedObject class]);
+    NSManagedObjectModel *model = [[NSManagedObjectModel alloc] init];
+    model.entities = @[entity];
+    NSPersistentStoreCoordinator *coordinator = [[NSPersistentStoreCoordinator alloc] initWithManagedObjectModel:model];
+    [coordinator addPersistentStoreWithType:NSInMemoryStoreType configuration:nil URL:nil options:nil error:NULL];
+    self.context = [[NSManagedObjectContext alloc] initWithConcurrencyType:NSMainQueueConcurrencyType];
+    self.context.persistentStoreCoordinator = coordinator;
+}
+
+- (void)tearDown {
+    self.context = nil;
+    [[NSFileManager defaultManager] removeItemAtURL:self.url error:NULL];
+    [super tearDown];
+}
+
+- (NSArray *)objectIDsWithCount:(NSUInteger)count {
+    NSMutableArray *objects = [NSMutableArray arrayWithCapacity:count];
+    for (NSUInteger i = 0; i < count; ++i) {
+        [objects addObject:[NSEntityDescription insertNewObjectForEntityForName:@"Item" inManagedObjectContext:self.context]];
+    }
+    [self.context obtainPermanentIDsForObjects:objects error:NULL];
+    return [objects valueForKey:@"objectID"];
+}
+
+- (NSArray *)allChangesOfLog:(INCoreDataChangeLog *)log sinceToken:(unsigned long long)token {
+    NSMutableArray *allChanges = [NSMutableArray array];
+    [log enumerateChangesSinceToken:token batchSize:1000 usingBlock:^(NSArray *changes, BOOL *stop) {
+        [allChanges addObjectsFromArray:changes];
+    }];
+    return allChanges;
+}
+
+
+#pragma mark - appending
+
+- (void)test_append_onNewLog_returnsIncreasingTokens {
+    INCoreDataChangeLog *log = [[INCoreDataChangeLog alloc] initWithUrl:self.url];
+    XCTAssertEqual(log.currentToken, 0ull, @"A new log has changes");
+    NSArray *objectIDs = [self objectIDsWithCount:3];
+    XCTAssertEqual([log appendInsertedObjectIDs:objectIDs updatedObjectIDs:nil deletedObjectIDs:nil], 3ull);
+    XCTAssertEqual([log appendInsertedObjectIDs:nil updatedObjectIDs:objectIDs deletedObjectIDs:@[objectIDs[0]]], 7ull);
+    XCTAssertEqual(log.currentToken, 7ull);
+
+    NSArray *changes = [self allChangesOfLog:log sinceToken:0];
+    XCTAssertEqual(changes.count, (NSUInteger)7);
+    INCoreDataChange *lastChange = [changes lastObject];
+    XCTAssertEqual(lastChange.type, INCoreDataChangeTypeDelete);
+    XCTAssertEqualObjects(lastChange.entityName, @"Item");
+    XCTAssertEqualObjects(lastChange.objectURI, [objectIDs[0] URIRepresentation]);
+}
+
+- (void)test_initWithUrl_onExistingLog_continuesTokens {
+    NSArray *objectIDs = [self objectIDsWithCount:300];
+    @autoreleasepool {
+        INCoreDataChangeLog *log = [[INCoreDataChangeLog alloc] initWithUrl:self.url];
+        [log appendInsertedObjectIDs:objectIDs updatedObjectIDs:nil deletedObjectIDs:nil];
+    }
+
+    INCoreDataChangeLog *reopenedLog = [[INCoreDataChangeLog alloc] initWithUrl:self.url];
+    XCTAssertEqual(reopenedLog.currentToken, 300ull, @"The reopened log lost its tokens");
+    XCTAssertEqual([reopenedLog appendInsertedObjectIDs:nil updatedObjectIDs:@[objectIDs[0]] deletedObjectIDs:nil], 301ull);
+
+    NSArray *changes = [self allChangesOfLog:reopenedLog sinceToken:299];
+    XCTAssertEqual(changes.count, (NSUInteger)2);
+    XCTAssertEqual([changes[0] token], 300ull);
+    XCTAssertEqual([changes[1] token], 301ull);
+    XCTAssertEqual([changes[1] type], INCoreDataChangeTypeUpdate);
+}
+
+- (void)test_append_onFailedWrite_leavesLogUnchanged {
+    INCoreDataChangeLog *log = [[INCoreDataChangeLog alloc] initWithUrl:self.url];
+    NSArray *objectIDs = [self objectIDsWithCount:2];
+    [log appendInsertedObjectIDs:objectIDs updatedObjectIDs:nil deletedObjectIDs:nil];
+
+    // replace the log's file with a read-only one, so each write fails
+    int fileDescriptor = [[log valueForKey:@"fileDescriptor"] intValue];
+    close(fileDescriptor);
+    [log setValue:@(open(self.url.path.fileSystemRepresentation, O_RDONLY)) forKey:@"fileDescriptor"];
+
+    XCTAssertEqual([log appendInsertedObjectIDs:nil updatedObjectIDs:objectIDs deletedObjectIDs:nil], 0ull, @"A failed write returned a token");
+    XCTAssertEqual(log.currentToken, 2ull, @"A failed write changed the current token");
+    NSArray *changes = [self allChangesOfLog:log sinceToken:0];
+    XCTAssertEqual(changes.count, (NSUInteger)2, @"A failed write changed the changes");
+
+    INCoreDataChangeLog *reopenedLog = [[INCoreDataChangeLog alloc] initWithUrl:self.url];
+    XCTAssertEqual(reopenedLog.currentToken, 2ull, @"A failed write changed the file");
+}
+
+
+#pragma mark - enumerating
+
+- (void)test_enumerateChanges_onBatchSize_passesBatchesInOrder {
+    INCoreDataChangeLog *log = [[INCoreDataChangeLog alloc] initWithUrl:nil];
+    [log appendInsertedObjectIDs:[self objectIDsWithCount:10] updatedObjectIDs:nil deletedObjectIDs:nil];
+
+    NSMutableArray *batchSizes = [NSMutableArray array];
+    __block unsigned long long lastToken = 3;
+    [log enumerateChangesSinceToken:3 batchSize:3 usingBlock:^(NSArray *changes, BOOL *stop) {
+        [batchSizes addObject:@(changes.count)];
+        for (INCoreDataChange *change in changes) {
+            XCTAssertEqual(change.token, lastToken + 1, @"Changes are not in the order of their tokens");
+            lastToken = change.token;
+        }
+    }];
+    XCTAssertEqualObjects(batchSizes, (@[@3, @3, @1]));
+    XCTAssertEqual(lastToken, 10ull);
+}
+
+- (void)test_enumerateChanges_onStop_endsEnumeration {
+    INCoreDataChangeLog *log = [[INCoreDataChangeLog alloc] initWithUrl:self.url];
+    [log appendInsertedObjectIDs:[self objectIDsWithCount:10] updatedObjectIDs:nil deletedObjectIDs:nil];
+
+    __block NSUInteger batchCount = 0;
+    [log enumerateChangesSinceToken:0 batchSize:4 usingBlock:^(NSArray *changes, BOOL *stop) {
+        ++batchCount;
+        *stop = YES;
+    }];
+    XCTAssertEqual(batchCount, (NSUInteger)1, @"The enumeration continued after stopping");
+}
+
+- (void)test_enumerateChanges_onLatestToken_passesNothing {
+    INCoreDataChangeLog *log = [[INCoreDataChangeLog alloc] initWithUrl:self.url];
+    [log appendInsertedObjectIDs:[self objectIDsWithCount:5] updatedObjectIDs:nil deletedObjectIDs:nil];
+    XCTAssertEqual([self allChangesOfLog:log sinceToken:log.currentToken].count, (NSUInteger)0);
+}
+
+@end
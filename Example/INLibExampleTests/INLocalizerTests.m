@@ -0,0 +1,102 @@
+//
+//  INLocalizerTests.m
+//  INLibExample
+//
+
+#import <UIKit/UIKit.h>
+#import <XCTest/XCTest.h>
+
+@interface INLocalizerTests : XCTestCase
+
+@end
+
+@implementation INLocalizerTests
+
+- (void)setUp {
+    [super setUp];
+    // Put setup code here. This method is called before the invocation of each test method in the class.
+}
+
+- (void)tearDown {
+    // Put teardown code here. This method is called after the invocation of each test method in the class.
+    [super tearDown];
+}
+
+- (void)assertPseudoString:(NSString *)string expect:(NSString *)expect {
+    NSString *result = INPseudoLocalizeString(string, INPseudoLocalizationAccents, 0);
+    XCTAssertEqualObjects(result, expect, @"'%@' was expected for '%@', but is '%@'", expect, string, result);
+}
+
+
+#pragma mark - INPseudoLocalizeString
+
+- (void)test_pseudoLocalizeString_onNone_returnsString {
+    XCTAssertEqualObjects(INPseudoLocalizeString(@"Hello World", INPseudoLocalizationNone, 40), @"Hello World");
+    XCTAssertEqualObjects(INPseudoLocalizeString(@"", INPseudoLocalizationNone, 0), @"");
+}
+
+- (void)test_pseudoLocalizeString_onAccents_replacesLetters {
+    [self assertPseudoString:@"Hello World" expect:@"Héllö Wörld"];
+    [self assertPseudoString:@"ABC xyz 123" expect:@"ÅBÇ xýž 123"];
+}
+
+- (void)test_pseudoLocalizeString_onBrackets_wrapsString {
+    XCTAssertEqualObjects(INPseudoLocalizeString(@"Hello", INPseudoLocalizationBrackets, 0), @"[Hello]");
+    XCTAssertEqualObjects(INPseudoLocalizeString(@"", INPseudoLocalizationBrackets, 0), @"[]");
+}
+
+- (void)test_pseudoLocalizeString_onExpansion_appendsPercentOfLength {
+    XCTAssertEqualObjects(INPseudoLocalizeString(@"Hello", INPseudoLocalizationExpansion, 40), @"Hello ··");
+    XCTAssertEqualObjects(INPseudoLocalizeString(@"Hello", INPseudoLocalizationExpansion, 50), @"Hello ···");
+    XCTAssertEqualObjects(INPseudoLocalizeString(@"Hello", INPseudoLocalizationExpansion, 0), @"Hello");
+    XCTAssertEqualObjects(INPseudoLocalizeString(@"Hello", INPseudoLocalizationAccents, 40), @"Héllö", @"Expanded without the expansion option");
+}
+
+- (void)test_pseudoLocalizeString_onAllOptions_combinesThem {
+    INPseudoLocalization all = INPseudoLocalizationAccents | INPseudoLocalizationBrackets | INPseudoLocalizationExpansion;
+    XCTAssertEqualObjects(INPseudoLocalizeString(@"Hello", all, 40), @"[Héllö ··]");
+}
+
+- (void)test_pseudoLocalizeString_onPlaceholders_keepsPlaceholders {
+    [self assertPseudoString:@"Hello %@" expect:@"Héllö %@"];
+    [self assertPseudoString:@"%1$d items in %2$@" expect:@"%1$d îtémš îñ %2$@"];
+    [self assertPseudoString:@"%lu files, 100%% done" expect:@"%lu fîléš, 100%% döñé"];
+}
+
+- (void)test_pseudoLocalizeString_onSimpleArguments_keepsArguments {
+    [self assertPseudoString:@"Hello {0}" expect:@"Héllö {0}"];
+    [self assertPseudoString:@"{0, number, integer} coins" expect:@"{0, number, integer} çöîñš"];
+}
+
+- (void)test_pseudoLocalizeString_onPluralArgument_keepsKeywordsAndTransformsMessages {
+    [self assertPseudoString:@"{0, plural, =0 {no files} one {# file} other {# files}}"
+                      expect:@"{0, plural, =0 {ñö fîléš} one {# fîlé} other {# fîléš}}"];
+    [self assertPseudoString:@"{0, plural, offset:1 one {you} other {you and {1}}}"
+                      expect:@"{0, plural, offset:1 one {ýöü} other {ýöü áñd {1}}}"];
+}
+
+- (void)test_pseudoLocalizeString_onSelectArgument_keepsKeywordsAndTransformsMessages {
+    [self assertPseudoString:@"{0, select, male {his} female {her} other {their}} son"
+                      expect:@"{0, select, male {hîš} female {hér} other {théîr}} šöñ"];
+}
+
+- (void)test_pseudoLocalizeString_onUnknownArgumentType_keepsArgument {
+    [self assertPseudoString:@"{0, selectordinal, one {#st} other {#th}} place"
+                      expect:@"{0, selectordinal, one {#st} other {#th}} pláçé"];
+}
+
+- (void)test_pseudoLocalizeString_onQuotedBraces_transformsQuotedText {
+    [self assertPseudoString:@"Use '{'name'}' for {0}" expect:@"Üšé '{'ñámé'}' för {0}"];
+    [self assertPseudoString:@"it''s {0}" expect:@"ît''š {0}"];
+    [self assertPseudoString:@"{0, plural, other {'#' is # and '{0}'}}" expect:@"{0, plural, other {'#' îš # áñd '{0}'}}"];
+}
+
+- (void)test_pseudoLocalizeString_onMessageFormat_formatsLikeOriginal {
+    NSString *pattern = @"{0, plural, one {# file} other {# files}} in {1}";
+    NSString *pseudoPattern = INPseudoLocalizeString(pattern, INPseudoLocalizationAccents | INPseudoLocalizationBrackets, 0);
+    INMessageFormat *format = [INMessageFormat messageFormatWithPattern:pseudoPattern];
+    XCTAssertNotNil(format, @"Pseudo localized pattern is invalid");
+    XCTAssertEqualObjects([format stringWithArguments:@[@2, @"Docs"] language:@"en"], @"[2 fîléš îñ Docs]");
+}
+
+@end
@@ -0,0 +1,113 @@
+//
+//  INMessageFormatTests.m
+//  INLibExample
+//
+
+#import <UIKit/UIKit.h>
+#import <XCTest/XCTest.h>
+
+@interface INMessageFormatTests : XCTestCase
+
+@end
+
+@implementation INMessageFormatTests
+
+- (void)setUp {
+    [super setUp];
+    // Put setup code here. This method is called before the invocation of each test method in the class.
+}
+
+- (void)tearDown {
+    // Put teardown code here. This method is called after the invocation of each test method in the class.
+    [super tearDown];
+}
+
+- (void)assertPattern:(NSString *)pattern arguments:(NSArray *)arguments language:(NSString *)language expect:(NSString *)expect {
+    INMessageFormat *format = [INMessageFormat messageFormatWithPattern:pattern];
+    XCTAssertNotNil(format, @"Pattern '%@' could not be compiled", pattern);
+    NSString *result = [format stringWithArguments:arguments language:language];
+    XCTAssert([result isEqualToString:expect], @"'%@' was expected, but is '%@'", expect, result);
+}
+
+
+#pragma mark - arguments
+
+- (void)test_stringWithArguments_onPositionalArguments_insertsArguments {
+    [self assertPattern:@"{1} and {0}" arguments:@[@"first", @2] language:@"en" expect:@"2 and first"];
+    [self assertPattern:@"no arguments" arguments:nil language:@"en" expect:@"no arguments"];
+    [self assertPattern:@"{0} {1}" arguments:@[@"one"] language:@"en" expect:@"one {1}"];
+}
+
+- (void)test_stringWithArguments_onQuotedText_insertsLiteralText {
+    [self assertPattern:@"'{0}' is {0}" arguments:@[@"x"] language:@"en" expect:@"{0} is x"];
+    [self assertPattern:@"it''s {0}" arguments:@[@"x"] language:@"en" expect:@"it's x"];
+    [self assertPattern:@"it's" arguments:nil language:@"en" expect:@"it's"];
+}
+
+
+#pragma mark - plural
+
+- (void)test_stringWithArguments_onPluralInEnglish_selectsCategory {
+    NSString *pattern = @"{0, plural, =0 {no files} one {# file} other {# files}}";
+    [self assertPattern:pattern arguments:@[@0] language:@"en" expect:@"no files"];
+    [self assertPattern:pattern arguments:@[@1] language:@"en" expect:@"1 file"];
+    [self assertPattern:pattern arguments:@[@5] language:@"en" expect:@"5 files"];
+    [self assertPattern:pattern arguments:@[@1.5] language:@"en" expect:@"1.5 files"];
+}
+
+- (void)test_stringWithArguments_onPluralWithOffset_usesOffsetNumber {
+    NSString *pattern = @"{0, plural, offset:1 =0 {nobody} =1 {you} one {you and # other} other {you and # others}}";
+    [self assertPattern:pattern arguments:@[@1] language:@"en" expect:@"you"];
+    [self assertPattern:pattern arguments:@[@2] language:@"en" expect:@"you and 1 other"];
+    [self assertPattern:pattern arguments:@[@4] language:@"en" expect:@"you and 3 others"];
+}
+
+- (void)test_stringWithArguments_onPluralInRussian_selectsCategory {
+    NSString *pattern = @"{0, plural, one {# one} few {# few} many {# many} other {# other}}";
+    [self assertPattern:pattern arguments:@[@21] language:@"ru" expect:@"21 one"];
+    [self assertPattern:pattern arguments:@[@3] language:@"ru" expect:@"3 few"];
+    [self assertPattern:pattern arguments:@[@12] language:@"ru" expect:@"12 many"];
+    [self assertPattern:pattern arguments:@[@11] language:@"ru" expect:@"11 many"];
+}
+
+- (void)test_pluralCategoryForNumber_onDifferentLanguages_returnsCategory {
+    XCTAssertEqual(INPluralCategoryForNumber(@"fr", 0), INPluralCategoryOne);
+    XCTAssertEqual(INPluralCategoryForNumber(@"de", 0), INPluralCategoryOther);
+    XCTAssertEqual(INPluralCategoryForNumber(@"de-AT", 1), INPluralCategoryOne);
+    XCTAssertEqual(INPluralCategoryForNumber(@"ja", 1), INPluralCategoryOther);
+    XCTAssertEqual(INPluralCategoryForNumber(@"pl", 22), INPluralCategoryFew);
+    XCTAssertEqual(INPluralCategoryForNumber(@"pl", 25), INPluralCategoryMany);
+    XCTAssertEqual(INPluralCategoryForNumber(@"ar", 2), INPluralCategoryTwo);
+    XCTAssertEqual(INPluralCategoryForNumber(@"ar", 111), INPluralCategoryMany);
+}
+
+- (void)test_pluralCategoryForNumber_onNonIntegerRepresentableNumbers_returnsOther {
+    XCTAssertEqual(INPluralCategoryForNumber(@"ru", NAN), INPluralCategoryOther);
+    XCTAssertEqual(INPluralCategoryForNumber(@"ru", INFINITY), INPluralCategoryOther);
+    XCTAssertEqual(INPluralCategoryForNumber(@"fr", -INFINITY), INPluralCategoryOther);
+    XCTAssertEqual(INPluralCategoryForNumber(@"pl", 0x1p64), INPluralCategoryOther);
+    XCTAssertEqual(INPluralCategoryForNumber(@"en", 1e300), INPluralCategoryOther);
+}
+
+
+#pragma mark - select
+
+- (void)test_stringWithArguments_onSelect_selectsMessage {
+    NSString *pattern = @"{0, select, male {his} female {her} other {their}} {1, plural, one {file} other {files}}";
+    [self assertPattern:pattern arguments:@[@"female", @1] language:@"en" expect:@"her file"];
+    [self assertPattern:pattern arguments:@[@"unknown", @2] language:@"en" expect:@"their files"];
+}
+
+
+#pragma mark - invalid patterns
+
+- (void)test_messageFormatWithPattern_onInvalidPattern_returnsNil {
+    XCTAssertNil([INMessageFormat messageFormatWithPattern:@"{0"]);
+    XCTAssertNil([INMessageFormat messageFormatWithPattern:@"0}"]);
+    XCTAssertNil([INMessageFormat messageFormatWithPattern:@"{0, plural, one {#}}"]);
+    XCTAssertNil([INMessageFormat messageFormatWithPattern:@"{0, select, male {his}}"]);
+    XCTAssertNil([INMessageFormat messageFormatWithPattern:@"{x}"]);
+}
+
+
+@end
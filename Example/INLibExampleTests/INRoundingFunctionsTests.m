@@ -0,0 +1,100 @@
+//
+//  INRoundingFunctionsTests.m
+//  INLibExample
+//
+
+#import <UIKit/UIKit.h>
+#import <XCTest/XCTest.h>
+
+@interface INRoundingFunctionsTests : XCTestCase
+
+@end
+
+@implementation INRoundingFunctionsTests
+
+- (void)setUp {
+    [super setUp];
+    // Put setup code here. This method is called before the invocation of each test method in the class.
+}
+
+- (void)tearDown {
+    // Put teardown code here. This method is called after the invocation of each test method in the class.
+    [super tearDown];
+}
+
+// Fills a buffer with values which include halves, negative values and signed zeros, whose rounding is easy to get wrong.
+- (void)fillValues:(CGFloat *)values count:(NSUInteger)count {
+    srand48(42);
+    for (NSUInteger i = 0; i < count; ++i) {
+        switch (i % 4) {
+            case 0: values[i] = (CGFloat)((drand48() - 0.5) * 2000.0); break;
+            case 1: values[i] = (CGFloat)((NSInteger)(drand48() * 2000.0) - 1000) + 0.5; break;
+            case 2: values[i] = (CGFloat)((NSInteger)(drand48() * 1000.0)) * 0.005; break;
+            default: values[i] = -(CGFloat)(drand48() * 0.5); break;
+        }
+    }
+    values[0] = -0.0;
+    values[1] = 2.5;
+    values[2] = -2.5;
+}
+
+- (void)assertArrayFunction:(void (*)(CGFloat *, NSUInteger, NSUInteger))arrayFunction digits:(NSUInteger)digits scalarFunction:(CGFloat (*)(CGFloat, NSUInteger))function {
+    // an odd count so the values not filling a whole vector are tested, too
+    NSUInteger const count = 1001;
+    CGFloat values[count];
+    CGFloat rounded[count];
+    [self fillValues:values count:count];
+    memcpy(rounded, values, sizeof(values));
+    arrayFunction(rounded, count, digits);
+    for (NSUInteger i = 0; i < count; ++i) {
+        CGFloat expected = function(values[i], digits);
+        XCTAssert(memcmp(&expected, &rounded[i], sizeof(CGFloat)) == 0, @"%.17g with %lu digits should be %.17g, but is %.17g", (double)values[i], (unsigned long)digits, (double)expected, (double)rounded[i]);
+    }
+}
+
+
+#pragma mark - powers of ten
+
+- (void)test_INPowerOfTen_onAllExponents_equalsPow {
+    for (NSUInteger n = 0; n < 30; ++n) {
+        XCTAssertEqual(INPowerOfTen(n), pow(10, n), @"10^%lu differs from pow", (unsigned long)n);
+        XCTAssertEqual(INPowerOfTenf(n), powf(10, n), @"10^%lu differs from powf", (unsigned long)n);
+    }
+}
+
+
+#pragma mark - array kernels
+
+- (void)test_INRoundFloats_onValues_equalsINRoundFloat {
+    for (NSUInteger digits = 0; digits < 25; ++digits) {
+        [self assertArrayFunction:INRoundFloats digits:digits scalarFunction:INRoundFloat];
+    }
+}
+
+- (void)test_INCeilFloats_onValues_equalsINCeilFloat {
+    for (NSUInteger digits = 0; digits < 25; ++digits) {
+        [self assertArrayFunction:INCeilFloats digits:digits scalarFunction:INCeilFloat];
+    }
+}
+
+- (void)test_INFloorFloats_onValues_equalsINFloorFloat {
+    for (NSUInteger digits = 0; digits < 25; ++digits) {
+        [self assertArrayFunction:INFloorFloats digits:digits scalarFunction:INFloorFloat];
+    }
+}
+
+- (void)test_INRoundFloats_onPrices_roundsToCents {
+    CGFloat prices[] = {1.994, 2.346, 9.999};
+    INRoundFloats(prices, 3, 2);
+    XCTAssertEqual(prices[0], (CGFloat)1.99);
+    XCTAssertEqual(prices[1], (CGFloat)2.35);
+    XCTAssertEqual(prices[2], (CGFloat)10.0);
+}
+
+- (void)test_INRoundFloats_onEmptyBuffer_doesNothing {
+    CGFloat value = 1.5;
+    INRoundFloats(&value, 0, 0);
+    XCTAssertEqual(value, (CGFloat)1.5);
+}
+
+@end
@@ -21,12 +21,41 @@
 // THE SOFTWARE.
 
 
-
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 
+// The powers of ten which are exactly representable, so they are identical to the results of pow(10, n) respectively powf(10, n).
+static const double INPowersOfTen[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+static const float INPowersOfTenf[] = {
+    1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f
+};
+
+/**
+ Returns 10 to the power of n as a double, taken from a table for the exactly representable values.
+ 
+ @param n The exponent.
+ @return The same value as pow(10, n).
+ */
+static inline double INPowerOfTen(NSUInteger n) {
+    return (n < sizeof(INPowersOfTen) / sizeof(INPowersOfTen[0])) ? INPowersOfTen[n] : pow(10, n);
+}
+
+/**
+ Returns 10 to the power of n as a float, taken from a table for the exactly representable values.
+ 
+ @param n The exponent.
+ @return The same value as powf(10, n).
+ */
+static inline float INPowerOfTenf(NSUInteger n) {
+    return (n < sizeof(INPowersOfTenf) / sizeof(INPowersOfTenf[0])) ? INPowersOfTenf[n] : powf(10, n);
+}
+
+
 /**
  Returns the input value rounded after a given number of digits after the decimal point.
 
@@ -40,10 +69,10 @@ extern "C" {
  */
 static inline CGFloat INRoundFloat(CGFloat value, NSUInteger digits) {
 #if CGFLOAT_IS_DOUBLE
-    double shift = pow(10, digits);
+    double shift = INPowerOfTen(digits);
     return round(value * shift) / shift;
 #else
-    float shift = powf(10, digits);
+    float shift = INPowerOfTenf(digits);
     return roundf(value * shift) / shift;
 #endif
 }
@@ -62,10 +91,10 @@ static inline CGFloat INRoundFloat(CGFloat value, NSUInteger digits) {
  */
 static inline CGFloat INCeilFloat(CGFloat value, NSUInteger digits) {
 #if CGFLOAT_IS_DOUBLE
-    double shift = pow(10, digits);
+    double shift = INPowerOfTen(digits);
     return ceil(value * shift) / shift;
 #else
-    float shift = powf(10, digits);
+    float shift = INPowerOfTenf(digits);
     return ceilf(value * shift) / shift;
 #endif
 }
@@ -84,16 +113,56 @@ static inline CGFloat INCeilFloat(CGFloat value, NSUInteger digits) {
  */
 static inline CGFloat INFloorFloat(CGFloat value, NSUInteger digits) {
 #if CGFLOAT_IS_DOUBLE
-    double shift = pow(10, digits);
+    double shift = INPowerOfTen(digits);
     return floor(value * shift) / shift;
 #else
-    float shift = powf(10, digits);
+    float shift = INPowerOfTenf(digits);
     return floorf(value * shift) / shift;
 #endif
 }
 
 
 
+/**
+ Rounds all values of a buffer in place after a given number of digits after the decimal point.
+ 
+ The results are identical to calling INRoundFloat for each value, but the power of ten is only determined once and the values are processed as vectors.
+ 
+    CGFloat prices[] = {1.994, 2.345, 9.999};
+    INRoundFloats(prices, 3, 2); // {1.99, 2.35, 10.0}
+ 
+ @param values The buffer of values which to round.
+ @param count The number of values in the buffer.
+ @param digits The number of digits after the period from which to round.
+ */
+void INRoundFloats(CGFloat *values, NSUInteger count, NSUInteger digits);
+
+
+/**
+ Ceils all values of a buffer in place up after a given number of digits after the decimal point.
+ 
+ The results are identical to calling INCeilFloat for each value, but the power of ten is only determined once and the values are processed as vectors.
+ 
+ @param values The buffer of values which to ceil.
+ @param count The number of values in the buffer.
+ @param digits The number of digits after the period from which to ceil.
+ */
+void INCeilFloats(CGFloat *values, NSUInteger count, NSUInteger digits);
+
+
+/**
+ Floors all values of a buffer in place down after a given number of digits after the decimal point.
+ 
+ The results are identical to calling INFloorFloat for each value, but the power of ten is only determined once and the values are processed as vectors.
+ 
+ @param values The buffer of values which to floor.
+ @param count The number of values in the buffer.
+ @param digits The number of digits after the period from which to floor.
+ */
+void INFloorFloats(CGFloat *values, NSUInteger count, NSUInteger digits);
+
+
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,157 @@
+// INRoundingFunctions.m
+//
+// Copyright (c) 2014 Sven Korset
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#import "INRoundingFunctions.h"
+
+#if defined(__aarch64__)
+#import <arm_neon.h>
+#elif defined(__SSE4_1__)
+#import <immintrin.h>
+#endif
+
+
+// The rounding kind of the array kernels.
+typedef NS_ENUM(NSInteger, INRoundingKernelMode) {
+    INRoundingKernelModeRound,
+    INRoundingKernelModeCeil,
+    INRoundingKernelModeFloor,
+};
+
+/*
+ Rounds all values of a buffer in place, used by INRoundFloats, INCeilFloats and INFloorFloats.
+ 
+ The values are processed with NEON on arm64, AVX or SSE4.1 on Intel if the compiler targets them, and the remaining values one by one.
+ Each lane does the same multiplication, rounding and division as the scalar functions, so the results are bit-identical.
+ SSE and AVX have no rounding half away from zero, so it's done by adding the largest value below 0.5 with the value's sign and truncating.
+ */
+static void INRoundFloatsWithMode(CGFloat *values, NSUInteger count, NSUInteger digits, INRoundingKernelMode mode) {
+    NSUInteger i = 0;
+#if CGFLOAT_IS_DOUBLE
+    double shift = INPowerOfTen(digits);
+#if defined(__aarch64__)
+    float64x2_t shiftVector = vdupq_n_f64(shift);
+    for (; i + 2 <= count; i += 2) {
+        float64x2_t vector = vmulq_f64(vld1q_f64(values + i), shiftVector);
+        vector = (mode == INRoundingKernelModeRound) ? vrndaq_f64(vector) : (mode == INRoundingKernelModeCeil) ? vrndpq_f64(vector) : vrndmq_f64(vector);
+        vst1q_f64(values + i, vdivq_f64(vector, shiftVector));
+    }
+#elif defined(__AVX__)
+    __m256d shiftVector = _mm256_set1_pd(shift);
+    __m256d signMask = _mm256_set1_pd(-0.0);
+    __m256d half = _mm256_set1_pd(0.49999999999999994);
+    for (; i + 4 <= count; i += 4) {
+        __m256d vector = _mm256_mul_pd(_mm256_loadu_pd(values + i), shiftVector);
+        if (mode == INRoundingKernelModeRound) {
+            vector = _mm256_add_pd(vector, _mm256_or_pd(_mm256_and_pd(vector, signMask), half));
+            vector = _mm256_round_pd(vector, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+        } else if (mode == INRoundingKernelModeCeil) {
+            vector = _mm256_round_pd(vector, _MM_FROUND_TO_POS_INF | _MM_FROUND_NO_EXC);
+        } else {
+            vector = _mm256_round_pd(vector, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+        }
+        _mm256_storeu_pd(values + i, _mm256_div_pd(vector, shiftVector));
+    }
+#elif defined(__SSE4_1__)
+    __m128d shiftVector = _mm_set1_pd(shift);
+    __m128d signMask = _mm_set1_pd(-0.0);
+    __m128d half = _mm_set1_pd(0.49999999999999994);
+    for (; i + 2 <= count; i += 2) {
+        __m128d vector = _mm_mul_pd(_mm_loadu_pd(values + i), shiftVector);
+        if (mode == INRoundingKernelModeRound) {
+            vector = _mm_add_pd(vector, _mm_or_pd(_mm_and_pd(vector, signMask), half));
+            vector = _mm_round_pd(vector, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+        } else if (mode == INRoundingKernelModeCeil) {
+            vector = _mm_round_pd(vector, _MM_FROUND_TO_POS_INF | _MM_FROUND_NO_EXC);
+        } else {
+            vector = _mm_round_pd(vector, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+        }
+        _mm_storeu_pd(values + i, _mm_div_pd(vector, shiftVector));
+    }
+#endif
+    for (; i < count; ++i) {
+        double value = values[i] * shift;
+        value = (mode == INRoundingKernelModeRound) ? round(value) : (mode == INRoundingKernelModeCeil) ? ceil(value) : floor(value);
+        values[i] = value / shift;
+    }
+#else
+    float shift = INPowerOfTenf(digits);
+#if defined(__aarch64__)
+    float32x4_t shiftVector = vdupq_n_f32(shift);
+    for (; i + 4 <= count; i += 4) {
+        float32x4_t vector = vmulq_f32(vld1q_f32(values + i), shiftVector);
+        vector = (mode == INRoundingKernelModeRound) ? vrndaq_f32(vector) : (mode == INRoundingKernelModeCeil) ? vrndpq_f32(vector) : vrndmq_f32(vector);
+        vst1q_f32(values + i, vdivq_f32(vector, shiftVector));
+    }
+#elif defined(__AVX__)
+    __m256 shiftVector = _mm256_set1_ps(shift);
+    __m256 signMask = _mm256_set1_ps(-0.0f);
+    __m256 half = _mm256_set1_ps(0.49999997f);
+    for (; i + 8 <= count; i += 8) {
+        __m256 vector = _mm256_mul_ps(_mm256_loadu_ps(values + i), shiftVector);
+        if (mode == INRoundingKernelModeRound) {
+            vector = _mm256_add_ps(vector, _mm256_or_ps(_mm256_and_ps(vector, signMask), half));
+            vector = _mm256_round_ps(vector, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+        } else if (mode == INRoundingKernelModeCeil) {
+            vector = _mm256_round_ps(vector, _MM_FROUND_TO_POS_INF | _MM_FROUND_NO_EXC);
+        } else {
+            vector = _mm256_round_ps(vector, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+        }
+        _mm256_storeu_ps(values + i, _mm256_div_ps(vector, shiftVector));
+    }
+#elif defined(__SSE4_1__)
+    __m128 shiftVector = _mm_set1_ps(shift);
+    __m128 signMask = _mm_set1_ps(-0.0f);
+    __m128 half = _mm_set1_ps(0.49999997f);
+    for (; i + 4 <= count; i += 4) {
+        __m128 vector = _mm_mul_ps(_mm_loadu_ps(values + i), shiftVector);
+        if (mode == INRoundingKernelModeRound) {
+            vector = _mm_add_ps(vector, _mm_or_ps(_mm_and_ps(vector, signMask), half));
+            vector = _mm_round_ps(vector, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+        } else if (mode == INRoundingKernelModeCeil) {
+            vector = _mm_round_ps(vector, _MM_FROUND_TO_POS_INF | _MM_FROUND_NO_EXC);
+        } else {
+            vector = _mm_round_ps(vector, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+        }
+        _mm_storeu_ps(values + i, _mm_div_ps(vector, shiftVector));
+    }
+#endif
+    for (; i < count; ++i) {
+        float value = values[i] * shift;
+        value = (mode == INRoundingKernelModeRound) ? roundf(value) : (mode == INRoundingKernelModeCeil) ? ceilf(value) : floorf(value);
+        values[i] = value / shift;
+    }
+#endif
+}
+
+
+void INRoundFloats(CGFloat *values, NSUInteger count, NSUInteger digits) {
+    INRoundFloatsWithMode(values, count, digits, INRoundingKernelModeRound);
+}
+
+void INCeilFloats(CGFloat *values, NSUInteger count, NSUInteger digits) {
+    INRoundFloatsWithMode(values, count, digits, INRoundingKernelModeCeil);
+}
+
+void INFloorFloats(CGFloat *values, NSUInteger count, NSUInteger digits) {
+    INRoundFloatsWithMode(values, count, digits, INRoundingKernelModeFloor);
+}
@@ -25,7 +25,9 @@
 #import "INBasicViewController.h"
 #import "INBasicTableViewCell.h"
 #import "INBasicTableViewHeaderFooterCell.h"
+#import "INCompiledStringsTable.h"
 #import "INLocalizer.h"
+#import "INMessageFormat.h"
 #import "INNavigationController.h"
 #import "INRandom.h"
 #import "INScrollView.h"
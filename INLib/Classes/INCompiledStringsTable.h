@@ -0,0 +1,128 @@
+// INCompiledStringsTable.h
+//
+// Copyright (c) 2014 Sven Korset
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#import <Foundation/Foundation.h>
+
+
+/// The file extension of a compiled strings table, i.e. 'Localizable.inlstrings'.
+extern NSString * const INCompiledStringsTableFileExtension;
+
+
+/**
+ A read-only strings table in a compact binary format which is memory mapped instead of being parsed.
+ 
+ The format is meant to be created at build time from a Localizable.strings file with the 'inlstrings' tool in the Tools folder,
+ so the app only maps the file when changing the language and reads the pages which are really used for a lookup.
+ 
+ The file consists of a header, an index of all entries sorted by the UTF-8 bytes of their keys and a pool with the UTF-8 bytes of all keys and values.
+ All numbers are 32 bit unsigned integers in little endian byte order.
+ 
+    header:  magic 'INLS', version, number of entries, offset of the index, offset of the pool, length of the pool
+    index:   per entry the key's offset and length followed by the value's offset and length, each relative to the pool
+    pool:    UTF-8 bytes without any terminating null characters
+ 
+ A lookup is a binary search in the index, so no hashing or other preparation is needed after mapping the file.
+ 
+    INCompiledStringsTable *table = [INCompiledStringsTable tableWithContentsOfFile:path];
+    NSString *translation = table[@"HelloWorld"];
+ 
+ */
+@interface INCompiledStringsTable : NSObject
+
+
+/// @name Creation
+
+/**
+ Maps a compiled strings table file into memory.
+ 
+ @param path The path to the compiled strings table file.
+ @return The table or nil if the file doesn't exist or is not a valid compiled strings table.
+ */
++ (instancetype)tableWithContentsOfFile:(NSString *)path;
+
+
+/**
+ Creates the binary representation of a strings table.
+ 
+ Used by the 'inlstrings' tool to compile a strings file, but may also be used to create a table at runtime.
+ 
+ @param dictionary A dictionary with NSString keys and NSString values, i.e. the content of a Localizable.strings file.
+ @return The data of a compiled strings table.
+ */
++ (NSData *)compiledDataWithDictionary:(NSDictionary *)dictionary;
+
+
+/**
+ Reads all pages of the mapped file, so the first lookups don't have to wait for the pages to be loaded.
+ 
+ Meant to be called on a background thread when the table will be needed soon.
+ */
+- (void)warmUp;
+
+
+/// @name Lookup
+
+/// The number of entries in the table.
+@property (nonatomic, assign, readonly) NSUInteger count;
+
+
+/**
+ Returns the value for a key.
+ 
+ This method may be called from any thread.
+ The decoded values are cached, so looking up the same key again neither searches the index nor creates a new string.
+ 
+ @param key The key to look up.
+ @return The string with the value of the key or nil if the table has no entry for the key.
+ */
+- (NSString *)objectForKey:(NSString *)key;
+
+
+/**
+ Same as objectForKey: for supporting the subscript syntax `table[key]`.
+ 
+ @param key The key to look up.
+ @return The string with the value of the key or nil if the table has no entry for the key.
+ */
+- (NSString *)objectForKeyedSubscript:(NSString *)key;
+
+
+/**
+ Enumerates all entries of the table in the order of the index.
+ 
+ @param block The block to call with each key and value. Setting stop to YES ends the enumeration.
+ */
+- (void)enumerateKeysAndObjectsUsingBlock:(void (^)(NSString *key, NSString *value, BOOL *stop))block;
+
+
+/**
+ Returns all entries of the table as a dictionary.
+ 
+ This creates a string for each key and value, so use this only when the table needs to be modified.
+ 
+ @return A new dictionary with all keys and values of the table.
+ */
+- (NSDictionary *)dictionaryRepresentation;
+
+
+@end
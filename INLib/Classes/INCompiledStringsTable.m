@@ -0,0 +1,287 @@
+// INCompiledStringsTable.m
+//
+// Copyright (c) 2014 Sven Korset
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#import "INCompiledStringsTable.h"
+#import <unistd.h>
+
+
+NSString * const INCompiledStringsTableFileExtension = @"inlstrings";
+
+
+// 'INLS' read as a little endian integer
+static uint32_t const INCompiledStringsTableMagic = 0x534C4E49;
+static uint32_t const INCompiledStringsTableVersion = 1;
+
+// the maximum UTF-8 length of a key which will be converted on the stack
+static NSUInteger const INCompiledStringsTableStackKeyLength = 256;
+
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t count;
+    uint32_t indexOffset;
+    uint32_t poolOffset;
+    uint32_t poolLength;
+} INCompiledStringsTableHeader;
+
+typedef struct {
+    uint32_t keyOffset;
+    uint32_t keyLength;
+    uint32_t valueOffset;
+    uint32_t valueLength;
+} INCompiledStringsTableEntry;
+
+
+// Compares two UTF-8 byte sequences the same way the index is sorted: byte by byte and then by length.
+static int INCompiledStringsTableCompare(const uint8_t *bytes1, uint32_t length1, const uint8_t *bytes2, uint32_t length2) {
+    int result = memcmp(bytes1, bytes2, MIN(length1, length2));
+    if (result != 0) {
+        return result;
+    }
+    if (length1 == length2) {
+        return 0;
+    }
+    return length1 < length2 ? -1 : 1;
+}
+
+
+
+@interface INCompiledStringsTable ()
+
+@property (nonatomic, strong) NSData *data; // the mapped file, which keeps the mapping alive as long as the table lives
+@property (nonatomic, assign, readwrite) NSUInteger count;
+@property (nonatomic, assign) const INCompiledStringsTableEntry *entries;
+@property (nonatomic, assign) const uint8_t *pool;
+@property (nonatomic, assign) uint32_t poolLength;
+@property (nonatomic, strong) NSCache *valueCache; // the decoded values by their keys, purged by the system when memory gets low
+
+@end
+
+
+@implementation INCompiledStringsTable
+
+
+#pragma mark - Creation
+
++ (instancetype)tableWithContentsOfFile:(NSString *)path {
+    if (path == nil) {
+        return nil;
+    }
+    // map the file instead of reading it, so only the touched pages will be loaded
+    NSData *data = [NSData dataWithContentsOfFile:path options:NSDataReadingMappedAlways error:NULL];
+    if (data == nil) {
+        return nil;
+    }
+    return [[self alloc] initWithData:data];
+}
+
+- (instancetype)initWithData:(NSData *)data {
+    self = [super init];
+    if (self == nil) return self;
+    
+    // validate the header and the sections' bounds, the entries themselves are checked when accessed
+    if (data.length < sizeof(INCompiledStringsTableHeader)) {
+        return nil;
+    }
+    const uint8_t *bytes = data.bytes;
+    const INCompiledStringsTableHeader *header = (const INCompiledStringsTableHeader *)bytes;
+    if (NSSwapLittleIntToHost(header->magic) != INCompiledStringsTableMagic || NSSwapLittleIntToHost(header->version) != INCompiledStringsTableVersion) {
+        return nil;
+    }
+    uint64_t count = NSSwapLittleIntToHost(header->count);
+    uint64_t indexOffset = NSSwapLittleIntToHost(header->indexOffset);
+    uint64_t poolOffset = NSSwapLittleIntToHost(header->poolOffset);
+    uint64_t poolLength = NSSwapLittleIntToHost(header->poolLength);
+    if (indexOffset % sizeof(uint32_t) != 0
+        || indexOffset + count * sizeof(INCompiledStringsTableEntry) > data.length
+        || poolOffset + poolLength > data.length) {
+        return nil;
+    }
+    
+    self.data = data;
+    self.count = (NSUInteger)count;
+    self.entries = (const INCompiledStringsTableEntry *)(bytes + indexOffset);
+    self.pool = bytes + poolOffset;
+    self.poolLength = (uint32_t)poolLength;
+    self.valueCache = [[NSCache alloc] init];
+    
+    return self;
+}
+
++ (NSData *)compiledDataWithDictionary:(NSDictionary *)dictionary {
+    // sort the keys by their UTF-8 bytes, which is the order the lookup's binary search expects
+    NSMutableArray *keys = [NSMutableArray arrayWithCapacity:dictionary.count];
+    for (id key in dictionary) {
+        if ([key isKindOfClass:[NSString class]] && [dictionary[key] isKindOfClass:[NSString class]]) {
+            [keys addObject:key];
+        }
+    }
+    [keys sortUsingComparator:^NSComparisonResult(NSString *key1, NSString *key2) {
+        NSData *bytes1 = [key1 dataUsingEncoding:NSUTF8StringEncoding];
+        NSData *bytes2 = [key2 dataUsingEncoding:NSUTF8StringEncoding];
+        int result = INCompiledStringsTableCompare(bytes1.bytes, (uint32_t)bytes1.length, bytes2.bytes, (uint32_t)bytes2.length);
+        return result < 0 ? NSOrderedAscending : (result > 0 ? NSOrderedDescending : NSOrderedSame);
+    }];
+    
+    // fill the pool and the index
+    NSMutableData *pool = [NSMutableData data];
+    NSMutableData *index = [NSMutableData dataWithCapacity:keys.count * sizeof(INCompiledStringsTableEntry)];
+    for (NSString *key in keys) {
+        NSData *keyBytes = [key dataUsingEncoding:NSUTF8StringEncoding];
+        NSData *valueBytes = [dictionary[key] dataUsingEncoding:NSUTF8StringEncoding];
+        INCompiledStringsTableEntry entry;
+        entry.keyOffset = NSSwapHostIntToLittle((uint32_t)pool.length);
+        entry.keyLength = NSSwapHostIntToLittle((uint32_t)keyBytes.length);
+        [pool appendData:keyBytes];
+        entry.valueOffset = NSSwapHostIntToLittle((uint32_t)pool.length);
+        entry.valueLength = NSSwapHostIntToLittle((uint32_t)valueBytes.length);
+        [pool appendData:valueBytes];
+        [index appendBytes:&entry length:sizeof(entry)];
+    }
+    
+    INCompiledStringsTableHeader header;
+    header.magic = NSSwapHostIntToLittle(INCompiledStringsTableMagic);
+    header.version = NSSwapHostIntToLittle(INCompiledStringsTableVersion);
+    header.count = NSSwapHostIntToLittle((uint32_t)keys.count);
+    header.indexOffset = NSSwapHostIntToLittle((uint32_t)sizeof(header));
+    header.poolOffset = NSSwapHostIntToLittle((uint32_t)(sizeof(header) + index.length));
+    header.poolLength = NSSwapHostIntToLittle((uint32_t)pool.length);
+    
+    NSMutableData *data = [NSMutableData dataWithBytes:&header length:sizeof(header)];
+    [data appendData:index];
+    [data appendData:pool];
+    return data;
+}
+
+
+- (void)warmUp {
+    // touch one byte of each page, the volatile sum keeps the compiler from dropping the reads
+    const uint8_t *bytes = self.data.bytes;
+    NSUInteger length = self.data.length;
+    NSUInteger pageSize = (NSUInteger)getpagesize();
+    volatile uint8_t sum = 0;
+    for (NSUInteger offset = 0; offset < length; offset += pageSize) {
+        sum += bytes[offset];
+    }
+}
+
+
+#pragma mark - Lookup
+
+- (BOOL)getBytes:(const uint8_t **)bytes offset:(uint32_t)offset length:(uint32_t)length {
+    uint64_t end = (uint64_t)NSSwapLittleIntToHost(offset) + NSSwapLittleIntToHost(length);
+    if (end > self.poolLength) {
+        // corrupted entry
+        return NO;
+    }
+    *bytes = self.pool + NSSwapLittleIntToHost(offset);
+    return YES;
+}
+
+- (NSString *)stringWithOffset:(uint32_t)offset length:(uint32_t)length {
+    const uint8_t *bytes;
+    if (![self getBytes:&bytes offset:offset length:length]) {
+        return nil;
+    }
+    // Copy the bytes, because a returned string may outlive the mapping of this table.
+    return [[NSString alloc] initWithBytes:bytes length:NSSwapLittleIntToHost(length) encoding:NSUTF8StringEncoding];
+}
+
+- (NSString *)objectForKey:(NSString *)key {
+    if (key == nil || self.count == 0) {
+        return nil;
+    }
+    
+    // repeated lookups of the same key neither search nor decode again
+    NSString *value = [self.valueCache objectForKey:key];
+    if (value != nil) {
+        return value;
+    }
+    
+    // get the key's UTF-8 bytes, short keys without a heap allocation
+    uint8_t buffer[INCompiledStringsTableStackKeyLength];
+    const uint8_t *keyBytes = buffer;
+    NSUInteger keyLength = 0;
+    NSRange remainingRange;
+    NSData *keyData = nil;
+    [key getBytes:buffer maxLength:sizeof(buffer) usedLength:&keyLength encoding:NSUTF8StringEncoding options:0 range:NSMakeRange(0, key.length) remainingRange:&remainingRange];
+    if (remainingRange.length > 0) {
+        keyData = [key dataUsingEncoding:NSUTF8StringEncoding];
+        keyBytes = keyData.bytes;
+        keyLength = keyData.length;
+    }
+    
+    // binary search in the sorted index
+    const INCompiledStringsTableEntry *entries = self.entries;
+    NSUInteger low = 0;
+    NSUInteger high = self.count;
+    while (low < high) {
+        NSUInteger middle = low + (high - low) / 2;
+        const INCompiledStringsTableEntry *entry = &entries[middle];
+        const uint8_t *entryBytes;
+        if (![self getBytes:&entryBytes offset:entry->keyOffset length:entry->keyLength]) {
+            return nil;
+        }
+        int result = INCompiledStringsTableCompare(keyBytes, (uint32_t)keyLength, entryBytes, NSSwapLittleIntToHost(entry->keyLength));
+        if (result == 0) {
+            value = [self stringWithOffset:entry->valueOffset length:entry->valueLength];
+            if (value != nil) {
+                [self.valueCache setObject:value forKey:[key copy]];
+            }
+            return value;
+        } else if (result < 0) {
+            high = middle;
+        } else {
+            low = middle + 1;
+        }
+    }
+    return nil;
+}
+
+- (NSString *)objectForKeyedSubscript:(NSString *)key {
+    return [self objectForKey:key];
+}
+
+- (void)enumerateKeysAndObjectsUsingBlock:(void (^)(NSString *key, NSString *value, BOOL *stop))block {
+    BOOL stop = NO;
+    for (NSUInteger index = 0; index < self.count && !stop; index++) {
+        const INCompiledStringsTableEntry *entry = &self.entries[index];
+        NSString *key = [self stringWithOffset:entry->keyOffset length:entry->keyLength];
+        NSString *value = [self stringWithOffset:entry->valueOffset length:entry->valueLength];
+        if (key != nil && value != nil) {
+            block(key, value, &stop);
+        }
+    }
+}
+
+- (NSDictionary *)dictionaryRepresentation {
+    NSMutableDictionary *dictionary = [NSMutableDictionary dictionaryWithCapacity:self.count];
+    [self enumerateKeysAndObjectsUsingBlock:^(NSString *key, NSString *value, BOOL *stop) {
+        dictionary[key] = value;
+    }];
+    return [dictionary copy];
+}
+
+
+@end
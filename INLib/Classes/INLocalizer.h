@@ -22,6 +22,23 @@
 
 
 #import "INMacros.h"
+#import "INMessageFormat.h"
+
+
+
+/**
+ Transformations applied to all translations for testing layouts with longer or unusual translations.
+ */
+typedef NS_OPTIONS(NSUInteger, INPseudoLocalization) {
+    /// No transformation.
+    INPseudoLocalizationNone = 0,
+    /// Replaces letters with accented ones, i.e. "Hello" becomes "Héllö".
+    INPseudoLocalizationAccents = 1 << 0,
+    /// Wraps each translation in brackets to reveal truncated or concatenated texts, i.e. "[Hello]".
+    INPseudoLocalizationBrackets = 1 << 1,
+    /// Appends characters to each translation by the percentage set with the expansion.
+    INPseudoLocalizationExpansion = 1 << 2,
+};
 
 
 
@@ -38,12 +55,46 @@
 NSString *INLocalizeString(NSString *string);
 
 
+/**
+ Global function for localizing a message format with INLocalizer.
+ 
+ Shortcut for:
+ 
+    [[INLocalizer sharedInstance] localizeFormat:key arguments:arguments]
+ 
+ @param key The key of the localized message pattern.
+ @param arguments The positional arguments of the message.
+ @return The localized and formatted message.
+ */
+NSString *INLocalizeFormat(NSString *key, NSArray *arguments);
+
+
+/**
+ Returns the pseudo localized version of a translation, as used for all tables when enabled with setPseudoLocalization:expansion:.
+ 
+ Placeholders like '%@' or '%1$d' as well as the arguments of message formats are kept unchanged, so formatting still works.
+ The texts of plural and select messages are visible texts and are transformed too, quoted braces stay literal text.
+ 
+    INPseudoLocalizeString(@"Hello {0}", INPseudoLocalizationAccents | INPseudoLocalizationBrackets, 0) // "[Héllö {0}]"
+ 
+ @param string The translation to transform.
+ @param pseudoLocalization The transformations to apply.
+ @param expansion The length in percent of the translation to append when using INPseudoLocalizationExpansion.
+ @return The pseudo localized translation.
+ */
+NSString *INPseudoLocalizeString(NSString *string, INPseudoLocalization pseudoLocalization, NSUInteger expansion);
+
+
 
 /**
  The localizer uses the current bundle language for localizing strings, but may also be switched to a different language during runtime of the app.
  
  By default does the same as NSLocalizedString(string, string).
  Changing the language affects only the strings localized with localizeString:.
+ The Localizable.strings table of a language is loaded once when setting the language and kept in memory as an immutable dictionary,
+ so localizing a string is only a hash lookup which is safe to call from any thread.
+ If the language bundle contains a Localizable.inlstrings file compiled with the 'inlstrings' tool, this file is memory mapped
+ and used instead of the strings file, which saves parsing the strings file at all (see INCompiledStringsTable).
  UIImage objects or UINib files are not localized this way.
  
     NSString *localizedString = INLocalizeString(@"localizedStringKey");
@@ -53,12 +104,39 @@ NSString *INLocalizeString(NSString *string);
     [[INLocalizer sharedInstance] setLanguage:@"de"];
     NSString *localizedString = INLocalizeString(@"localizedStringKey");
 
+ Besides the singleton, which is used by INLocalizeString and for localizing views, independent instances may be created for other languages,
+ i.e. for rendering content in many languages concurrently.
+ All localizers share the loaded tables of a language, which are immutable and released when no localizer uses them anymore.
+ 
+    INLocalizer *frenchLocalizer = [[INLocalizer alloc] initWithLanguage:@"fr"];
+    NSString *frenchString = [frenchLocalizer localizeString:@"localizedStringKey"];
+    NSString *germanString = [INLocalizer localizeString:@"localizedStringKey" language:@"de"];
+
+ Strings missing in a language are taken from its fallback languages, which are the more general languages of a regional one,
+ i.e. "de" for "de-AT", followed by the fallback languages set with setFallbackLanguages:forLanguage:.
+ All fallbacks are merged into the language's table when it's loaded, so a lookup stays a single hash lookup.
+ 
+    [INLocalizer setFallbackLanguages:@[@"en"] forLanguage:nil];
+    [[INLocalizer sharedInstance] setLanguage:@"de-AT"]; // uses "de-AT", then "de", then "en"
+    NSDictionary *missingKeys = [[INLocalizer sharedInstance] missingKeysByLanguage];
+
  */
 @interface INLocalizer : NSObject
 
 INSingletonDeclaration
 
 
+/**
+ Initializes an independent localizer for a language.
+ 
+ The singleton is not affected by this instance and vice versa.
+ 
+ @param language The language to use, see setLanguage:. If nil or not available the main bundle's language will be used.
+ @return The initialized localizer.
+ */
+- (instancetype)initWithLanguage:(NSString *)language;
+
+
 /**
  The bundle to use for localizing, defaults to the main bundle.
  
@@ -67,12 +145,97 @@ INSingletonDeclaration
 @property (nonatomic, strong, readonly) NSBundle *bundle;
 
 
+/**
+ A number which will be increased each time the language changes.
+ 
+ Views remember the generation with which they have been localized, so localizeStrings can skip them until the language changes again.
+ */
+@property (atomic, assign, readonly) NSUInteger languageGeneration;
+
+
+/**
+ The code of the language currently used, i.e. "de".
+ 
+ Without manually setting a language this is the main bundle's preferred localization.
+ Decides which plural rules are used by localizeFormat:arguments:.
+ */
+@property (atomic, copy, readonly) NSString *language;
+
+
+/**
+ The keys which are missing in the languages of the current fallback chain.
+ 
+ The dictionary's keys are the language codes of all available languages in the chain, the values are NSSet objects
+ with the keys which are provided by another language of the chain but not by this one.
+ Useful for sizing the translation backlog of a language.
+ */
+@property (nonatomic, strong, readonly) NSDictionary *missingKeysByLanguage;
+
+
+/**
+ Sets the languages to fall back to when a key is missing in a language.
+ 
+ The more general languages of a language, i.e. "de" for "de-AT", come always first, followed by these languages.
+ Fallback languages without a language bundle are ignored.
+ Already loaded tables keep their fallbacks, so set the fallbacks before setting a language or creating localizers.
+ 
+ @param fallbackLanguages The languages to use in this order when a key is missing. May be nil to remove the fallbacks.
+ @param language The language for which to set the fallbacks or nil for setting the fallbacks of all languages without own fallbacks.
+ */
++ (void)setFallbackLanguages:(NSArray *)fallbackLanguages forLanguage:(NSString *)language;
+
+
+/**
+ Enables a pseudo localization which transforms all translations.
+ 
+ The translations are transformed once when a table is loaded, so the lookup itself has no extra cost, neither enabled nor disabled.
+ Placeholders like '%@' and the arguments of message formats stay unchanged, while the texts of their plural and select messages are transformed. Keys without a translation are not transformed,
+ which makes hard coded or untranslated texts visible.
+ Already loaded tables are discarded, but localizers keep their current table, so set the language again afterwards.
+ 
+    [INLocalizer setPseudoLocalization:INPseudoLocalizationAccents | INPseudoLocalizationBrackets | INPseudoLocalizationExpansion expansion:40];
+    [[INLocalizer sharedInstance] setLanguage:@"en"];
+    [controller localizeStrings];
+    XCTAssertEqual([[controller.view viewsWithTruncatedText] count], 0);
+ 
+ @param pseudoLocalization The transformations to apply or INPseudoLocalizationNone to disable the pseudo localization.
+ @param percent The length in percent of a translation to append when using INPseudoLocalizationExpansion, i.e. 30 for 30% longer texts.
+ */
++ (void)setPseudoLocalization:(INPseudoLocalization)pseudoLocalization expansion:(NSUInteger)percent;
+
+
+/**
+ Loads the tables of languages in the background, so switching to one of them later doesn't block the main thread.
+ 
+ The tables are loaded on a background queue and made available to all localizers only when they are completely loaded.
+ Preloaded tables stay in memory until the fallback languages or the pseudo localization change,
+ a table loaded while they change is discarded.
+ 
+    [INLocalizer preloadLanguages:@[@"de", @"fr"] completion:^{
+        self.languageButtonsEnabled = YES;
+    }];
+    ...
+    [[INLocalizer sharedInstance] setLanguage:@"de"]; // instant
+ 
+ @param languages The languages to load, see setLanguage:.
+ @param completion The block to call on the main queue when all languages are loaded. May be nil.
+ */
++ (void)preloadLanguages:(NSArray *)languages completion:(void (^)(void))completion;
+
+
 /**
  Sets a new language for localizing.
  
+ Setting the same language again does nothing.
  The Localizable.strings file for the given language has to be in the language's bundle.
+ The whole strings file will be loaded by this method and replaces the previous language's table at once,
+ so concurrent calls of localizeString: return either the old or the new translation, but never fail.
  After setting a new language each returned localization string is from the language's strings file.
  So after changing the language make sure to refresh the views.
+ Loading the language's table happens on the calling thread unless the language has been preloaded with preloadLanguages:completion:.
+ While a preload of the language is still running, this waits for the preloaded table instead of loading it a second time.
+
+ When the language's bundle doesn't exist its fallback languages will be tried before resetting to the main bundle's language.
 
  @param language The language to use. Has to be the name of the project's language, meaning the folder's name in which the Localizable.strings is without the lproj postfix. Normally this is a ISO language code, i.e. "de".
  */
@@ -84,6 +247,7 @@ INSingletonDeclaration
  
  The given string will be localized with the currently set language bundle file.
  Without manually setting a different language this method does the same as NSLocalizedString(string, string).
+ This method may be called from any thread.
 
  @param string The string to localize.
  @return The localized string.
@@ -106,6 +270,112 @@ INSingletonDeclaration
 + (NSString *)localizeString:(NSString *)string;
 
 
+/**
+ Localizes a string with an explicit language without using the singleton.
+ 
+ Uses the table shared by all localizers with this language, which will be loaded when no localizer has loaded it yet.
+ When localizing many strings create a localizer with initWithLanguage: instead, which saves looking up the language's table each time.
+ This method may be called from any thread.
+ 
+ @param string The string to localize.
+ @param language The language to use, see setLanguage:.
+ @return The localized string.
+ */
++ (NSString *)localizeString:(NSString *)string language:(NSString *)language;
+
+
+/**
+ Localizes a message pattern and formats it with arguments.
+ 
+ The translation of the key is a pattern in the ICU message format syntax (see INMessageFormat), so plural forms are selected
+ by the plural rules of the current language.
+ 
+    // "Files" = "{0, plural, =0 {No files} one {One file} other {# files}}";
+    NSString *message = INLocalizeFormat(@"Files", @[@3]); // "3 files"
+ 
+ Each pattern is compiled once per language and messages are formatted into a buffer reused per thread.
+ An invalid pattern is returned unformatted.
+ This method may be called from any thread.
+ 
+ @param key The key of the localized message pattern.
+ @param arguments The positional arguments of the message.
+ @return The localized and formatted message.
+ */
+- (NSString *)localizeFormat:(NSString *)key arguments:(NSArray *)arguments;
+
+
+/**
+ Localizes a message pattern and formats it with arguments by the singleton.
+ 
+ Same as calling:
+ 
+    [[INLocalizer sharedInstance] localizeFormat:key arguments:arguments]
+ 
+ @param key The key of the localized message pattern.
+ @param arguments The positional arguments of the message.
+ @return The localized and formatted message.
+ */
++ (NSString *)localizeFormat:(NSString *)key arguments:(NSArray *)arguments;
+
+
+/**
+ Localizes a message pattern with an explicit language and formats it without using the singleton.
+ 
+ @param key The key of the localized message pattern.
+ @param arguments The positional arguments of the message.
+ @param language The language to use, see setLanguage:.
+ @return The localized and formatted message.
+ @see localizeString:language:
+ */
++ (NSString *)localizeFormat:(NSString *)key arguments:(NSArray *)arguments language:(NSString *)language;
+
+
+/// @name Instrumentation
+
+/**
+ Enables or disables recording statistics about the localization, disabled by default.
+ 
+ When enabled each lookup is counted per key along with misses, which are lookups without a translation or a translation equal to its key,
+ and the time spent in localizeStrings traversals is measured.
+ Each thread records into its own counters, which are merged only when creating a report.
+ When disabled the cost is a single flag check per lookup.
+ 
+ @param enabled YES to record statistics.
+ */
++ (void)setInstrumentationEnabled:(BOOL)enabled;
+
+/**
+ Returns true if statistics are recorded.
+ 
+ @return True if instrumentation is enabled.
+ */
++ (BOOL)isInstrumentationEnabled;
+
+/**
+ Discards all recorded statistics.
+ */
++ (void)resetInstrumentation;
+
+/**
+ Returns the merged statistics of all threads.
+ 
+ The report has the keys "lookups" and "misses" with dictionaries of the lookup counts per localization key,
+ "unusedKeys" with a sorted array of the singleton's current keys which have never been looked up,
+ "traversals" with the number of localizeStrings calls on view hierarchies, "traversedViews" with the number of views localized by them
+ and "traversalSeconds" with the total time spent.
+ 
+ @return The report as a dictionary.
+ */
++ (NSDictionary *)instrumentationReport;
+
+/**
+ Returns the instrumentationReport as JSON data.
+ 
+ @return The report as UTF-8 encoded JSON.
+ */
++ (NSData *)instrumentationReportJSON;
+
+
 @end
 
 
@@ -114,9 +384,42 @@ INSingletonDeclaration
 
 /**
  Localizes all strings in this view (UILabel, UIButton, etc) and it's subviews.
+ 
+ Each view remembers the localizer's languageGeneration it has been localized with,
+ so the strings of a view which is already localized with the current language won't be looked up again.
+ The subviews are always visited, so subviews added or replaced since the last call will be localized too.
+ A setter will only be called when the localized string differs from the current one.
+ The original key of each localized property is remembered, so after a language change the translation is looked up with the key
+ and not with the previously displayed translation. A property which has been set to a different string meanwhile uses that string as its new key.
+ Controls like UIButton, UITextField, UISegmentedControl and UISearchBar localize their titles but not their internal subviews,
+ custom subviews added to them and the text field's leftView and rightView are localized.
+ Strings changed in an already localized view are not localized again, so call setNeedsLocalization on the changed view.
  */
 - (void)localizeStrings;
 
+/**
+ Localizes only the strings of this view without its subviews.
+ 
+ Called by localizeStrings, so custom views with strings should override this method instead of localizeStrings.
+ */
+- (void)localizeOwnStrings;
+
+/**
+ Marks this view as not localized, so the next call of localizeStrings will localize its strings again.
+ */
+- (void)setNeedsLocalization;
+
+/**
+ Returns all visible labels in this view and its subviews whose text doesn't fit into their bounds.
+ 
+ Labels which adjust their font size to fit are ignored.
+ Meant for tests together with a pseudo localization to find texts which will be truncated by longer translations.
+ 
+ @return An array with the UILabel objects which truncate their text.
+ @see [INLocalizer setPseudoLocalization:expansion:]
+ */
+- (NSArray *)viewsWithTruncatedText;
+
 @end
 
 
@@ -22,18 +22,387 @@
 
 
 #import "INLocalizer.h"
+#import "INCompiledStringsTable.h"
+#import "INMessageFormat.h"
+#import <objc/runtime.h>
+#import <pthread.h>
+
+
+// The name of the strings file which will be loaded from a language bundle.
+static NSString * const INLocalizerStringsTableName = @"Localizable";
+
+// The key of the per thread buffer for formatting messages in the thread dictionary.
+static NSString * const INLocalizerMessageBufferKey = @"INLocalizerMessageBuffer";
 
 
 NSString *INLocalizeString(NSString *string) {
     return [[INLocalizer sharedInstance] localizeString:string];
 }
 
+NSString *INLocalizeFormat(NSString *key, NSArray *arguments) {
+    return [[INLocalizer sharedInstance] localizeFormat:key arguments:arguments];
+}
+
+
+#pragma mark - Instrumentation
+
+// Only checked flag when instrumentation is disabled.
+static BOOL __instrumentationEnabled = NO;
+
+
+/*
+ The statistics recorded by one thread.
+ 
+ Each thread records into its own instance, so the lock is never contended except while merging the statistics for a report.
+ When the thread finishes, its statistics are merged into the totals of all finished threads and the instance is released.
+ */
+@interface INLocalizerStatistics : NSObject {
+@public
+    pthread_mutex_t _mutex;
+}
+
+@property (nonatomic, strong) NSCountedSet *lookups;
+@property (nonatomic, strong) NSCountedSet *misses;
+@property (nonatomic, assign) NSUInteger traversals;
+@property (nonatomic, assign) NSUInteger traversedViews;
+@property (nonatomic, assign) CFTimeInterval traversalTime;
+
+// The nesting depth of localizeStrings calls, only the outermost call is measured as one traversal (owning thread only, not locked).
+@property (nonatomic, assign) NSUInteger traversalDepth;
+
+@end
+
+
+@implementation INLocalizerStatistics
+
+static pthread_key_t __statisticsKey; // the statistics of the current thread, retained until the thread finishes
+static NSMutableArray *__allStatistics = nil; // statistics of all running threads
+static NSMutableDictionary *__finishedLookupCounts = nil; // key -> count of all finished threads
+static NSMutableDictionary *__finishedMissCounts = nil; // key -> count of all finished threads
+static NSUInteger __finishedTraversals = 0;
+static NSUInteger __finishedTraversedViews = 0;
+static CFTimeInterval __finishedTraversalTime = 0;
+static dispatch_semaphore_t __allStatisticsLock = NULL;
+
+// Adds the counts of a counted set to a dictionary with counts.
+static void INLocalizerAddCounts(NSMutableDictionary *counts, NSCountedSet *set) {
+    for (NSString *key in set) {
+        counts[key] = @([counts[key] unsignedIntegerValue] + [set countForObject:key]);
+    }
+}
+
+// Called when a thread with statistics finishes.
+static void INLocalizerStatisticsThreadDidExit(void *value) {
+    @autoreleasepool {
+        INLocalizerStatistics *statistics = (__bridge_transfer INLocalizerStatistics *)value;
+        dispatch_semaphore_wait(__allStatisticsLock, DISPATCH_TIME_FOREVER);
+        INLocalizerAddCounts(__finishedLookupCounts, statistics.lookups);
+        INLocalizerAddCounts(__finishedMissCounts, statistics.misses);
+        __finishedTraversals += statistics.traversals;
+        __finishedTraversedViews += statistics.traversedViews;
+        __finishedTraversalTime += statistics.traversalTime;
+        [__allStatistics removeObjectIdenticalTo:statistics];
+        dispatch_semaphore_signal(__allStatisticsLock);
+    }
+}
+
++ (void)initialize {
+    if (self != [INLocalizerStatistics class]) {
+        return;
+    }
+    pthread_key_create(&__statisticsKey, INLocalizerStatisticsThreadDidExit);
+    __allStatistics = [NSMutableArray array];
+    __finishedLookupCounts = [NSMutableDictionary dictionary];
+    __finishedMissCounts = [NSMutableDictionary dictionary];
+    __allStatisticsLock = dispatch_semaphore_create(1);
+}
+
++ (instancetype)statisticsOfCurrentThread {
+    // a thread specific value is much cheaper than the thread dictionary
+    void *value = pthread_getspecific(__statisticsKey);
+    if (value != NULL) {
+        return (__bridge INLocalizerStatistics *)value;
+    }
+    INLocalizerStatistics *statistics = [[INLocalizerStatistics alloc] init];
+    pthread_setspecific(__statisticsKey, (__bridge_retained void *)statistics);
+    dispatch_semaphore_wait(__allStatisticsLock, DISPATCH_TIME_FOREVER);
+    [__allStatistics addObject:statistics];
+    dispatch_semaphore_signal(__allStatisticsLock);
+    return statistics;
+}
+
++ (NSDictionary *)mergedReportWithKeys:(NSArray *)allKeys {
+    dispatch_semaphore_wait(__allStatisticsLock, DISPATCH_TIME_FOREVER);
+    NSMutableDictionary *lookupCounts = [__finishedLookupCounts mutableCopy];
+    NSMutableDictionary *missCounts = [__finishedMissCounts mutableCopy];
+    NSUInteger traversals = __finishedTraversals;
+    NSUInteger traversedViews = __finishedTraversedViews;
+    CFTimeInterval traversalTime = __finishedTraversalTime;
+    for (INLocalizerStatistics *statistics in __allStatistics) {
+        pthread_mutex_lock(&statistics->_mutex);
+        INLocalizerAddCounts(lookupCounts, statistics.lookups);
+        INLocalizerAddCounts(missCounts, statistics.misses);
+        traversals += statistics.traversals;
+        traversedViews += statistics.traversedViews;
+        traversalTime += statistics.traversalTime;
+        pthread_mutex_unlock(&statistics->_mutex);
+    }
+    dispatch_semaphore_signal(__allStatisticsLock);
+    
+    NSMutableArray *unusedKeys = [NSMutableArray array];
+    for (NSString *key in allKeys) {
+        if (lookupCounts[key] == nil) {
+            [unusedKeys addObject:key];
+        }
+    }
+    [unusedKeys sortUsingSelector:@selector(compare:)];
+    
+    return @{@"lookups": lookupCounts,
+             @"misses": missCounts,
+             @"unusedKeys": unusedKeys,
+             @"traversals": @(traversals),
+             @"traversedViews": @(traversedViews),
+             @"traversalSeconds": @(traversalTime)};
+}
+
++ (void)reset {
+    dispatch_semaphore_wait(__allStatisticsLock, DISPATCH_TIME_FOREVER);
+    [__finishedLookupCounts removeAllObjects];
+    [__finishedMissCounts removeAllObjects];
+    __finishedTraversals = 0;
+    __finishedTraversedViews = 0;
+    __finishedTraversalTime = 0;
+    for (INLocalizerStatistics *statistics in __allStatistics) {
+        pthread_mutex_lock(&statistics->_mutex);
+        [statistics.lookups removeAllObjects];
+        [statistics.misses removeAllObjects];
+        statistics.traversals = 0;
+        statistics.traversedViews = 0;
+        statistics.traversalTime = 0;
+        pthread_mutex_unlock(&statistics->_mutex);
+    }
+    dispatch_semaphore_signal(__allStatisticsLock);
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self == nil) return self;
+    
+    pthread_mutex_init(&_mutex, NULL);
+    self.lookups = [[NSCountedSet alloc] init];
+    self.misses = [[NSCountedSet alloc] init];
+    
+    return self;
+}
+
+- (void)dealloc {
+    pthread_mutex_destroy(&_mutex);
+}
+
+@end
+
+
+static void INLocalizerRecordLookup(NSString *key, BOOL missed) {
+    INLocalizerStatistics *statistics = [INLocalizerStatistics statisticsOfCurrentThread];
+    pthread_mutex_lock(&statistics->_mutex);
+    [statistics.lookups addObject:key];
+    if (missed) {
+        [statistics.misses addObject:key];
+    }
+    pthread_mutex_unlock(&statistics->_mutex);
+}
+
+// Returns the start time of a traversal or 0 if it's a nested call.
+static CFAbsoluteTime INLocalizerBeginTraversal(void) {
+    INLocalizerStatistics *statistics = [INLocalizerStatistics statisticsOfCurrentThread];
+    return (statistics.traversalDepth++ == 0) ? CFAbsoluteTimeGetCurrent() : 0;
+}
+
+static void INLocalizerEndTraversal(CFAbsoluteTime startTime, NSUInteger views) {
+    INLocalizerStatistics *statistics = [INLocalizerStatistics statisticsOfCurrentThread];
+    statistics.traversalDepth--;
+    pthread_mutex_lock(&statistics->_mutex);
+    statistics.traversedViews += views;
+    if (startTime != 0) {
+        statistics.traversals++;
+        statistics.traversalTime += CFAbsoluteTimeGetCurrent() - startTime;
+    }
+    pthread_mutex_unlock(&statistics->_mutex);
+}
+
+
+// Key for the associated object holding the language generation with which an object has been localized.
+static const char *localizedGenerationKey = "INLocalize_localizedGeneration";
+
+
+// Returns the language generation with which the object has been localized or 0 if never.
+static NSUInteger INLocalizedGeneration(id object) {
+    return [objc_getAssociatedObject(object, localizedGenerationKey) unsignedIntegerValue];
+}
+
+// Returns true if the object has already been localized with the current language, otherwise marks it as localized with it.
+static BOOL INLocalizedGenerationIsCurrent(id object) {
+    NSUInteger generation = [[INLocalizer sharedInstance] languageGeneration];
+    if (INLocalizedGeneration(object) == generation) {
+        return YES;
+    }
+    objc_setAssociatedObject(object, localizedGenerationKey, @(generation), OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+    return NO;
+}
+
+// Key for the associated object holding the original localization keys of an object's localized properties.
+static const char *localizedStringRecordsKey = "INLocalize_localizedStringRecords";
+
+// The names of an object's localized properties as keys for the records.
+static NSString * const INLocalizedPropertyText = @"text";
+static NSString * const INLocalizedPropertyPlaceholder = @"placeholder";
+static NSString * const INLocalizedPropertyPrompt = @"prompt";
+static NSString * const INLocalizedPropertyTitle = @"title";
+
+
+// The original key of a localized property along with the localized string which has been set with it.
+@interface INLocalizedStringRecord : NSObject
+
+@property (nonatomic, copy) NSString *key;
+@property (nonatomic, copy) NSString *localizedString;
+
+@end
+
+@implementation INLocalizedStringRecord
+@end
+
+
+/*
+ Returns the localized string for an object's property.
+ 
+ The original key of the property is stored at the first localization, so a re-localization looks up the original key instead of the currently displayed translation.
+ When the property doesn't show the stored translation anymore, it has been changed from outside and the current string is taken as the new key.
+ The property is any object used as key for storing the record, i.e. the name of the property.
+ */
+static NSString *INLocalizedStringForProperty(id object, id<NSCopying> property, NSString *currentString) {
+    NSMutableDictionary *records = objc_getAssociatedObject(object, localizedStringRecordsKey);
+    INLocalizedStringRecord *record = records[property];
+    NSString *key = currentString;
+    if (record != nil && (currentString == record.localizedString || [currentString isEqualToString:record.localizedString])) {
+        key = record.key;
+    }
+    if (key == nil) {
+        [records removeObjectForKey:property];
+        return nil;
+    }
+    
+    NSString *localizedString = INLocalizeString(key);
+    if (record == nil) {
+        if (records == nil) {
+            records = [NSMutableDictionary dictionary];
+            objc_setAssociatedObject(object, localizedStringRecordsKey, records, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+        }
+        record = [[INLocalizedStringRecord alloc] init];
+        records[property] = record;
+    }
+    record.key = key;
+    record.localizedString = localizedString;
+    return localizedString;
+}
+
+// Returns true if a setter needs to be called to replace the current string with the localized one.
+static inline BOOL INLocalizedStringDiffers(NSString *currentString, NSString *localizedString) {
+    return currentString != localizedString && ![currentString isEqualToString:localizedString];
+}
+
+
+// Returns true if the view's class is defined by UIKit, i.e. one of the private subviews a control creates for itself.
+static BOOL INIsUIKitView(UIView *view) {
+    static NSBundle *uiKitBundle = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        uiKitBundle = [NSBundle bundleForClass:[UIView class]];
+    });
+    return [NSBundle bundleForClass:[view class]] == uiKitBundle;
+}
+
+// Returns true if a subview of a control is managed by the control, so its strings must not be localized again.
+typedef BOOL (*INManagesSubviewFunction)(UIView *view, UIView *subview);
+
+static BOOL INButtonManagesSubview(UIView *view, UIView *subview) {
+    // the title label shows the already localized title
+    return subview == [(UIButton *)view titleLabel];
+}
+
+static BOOL INTextFieldManagesSubview(UIView *view, UIView *subview) {
+    // the left and right views are the app's content, the placeholder label and the editor are the text field's
+    UITextField *textField = (UITextField *)view;
+    return subview != textField.leftView && subview != textField.rightView && INIsUIKitView(subview);
+}
+
+static BOOL INControlManagesSubview(UIView *view, UIView *subview) {
+    return INIsUIKitView(subview);
+}
+
+/*
+ Localizes a view's own strings when they are not already localized with the current language, then its subviews.
+ 
+ The subviews are always visited, because they may have been added or replaced since the view has been localized,
+ only those managed by the view are skipped when a function for identifying them is given.
+ */
+static void INLocalizeView(UIView *view, INManagesSubviewFunction managesSubview) {
+    BOOL instrumented = __instrumentationEnabled;
+    CFAbsoluteTime startTime = instrumented ? INLocalizerBeginTraversal() : 0;
+    if (!INLocalizedGenerationIsCurrent(view)) {
+        [view localizeOwnStrings];
+    }
+    for (UIView *subview in view.subviews) {
+        if (managesSubview == NULL || !managesSubview(view, subview)) {
+            [subview localizeStrings];
+        }
+    }
+    if (instrumented) {
+        INLocalizerEndTraversal(startTime, 1);
+    }
+}
+
 
 @implementation UIView (INLocalize)
 
 - (void)localizeStrings {
+    INLocalizeView(self, NULL);
+}
+
+- (void)localizeOwnStrings {
+    // to implement by subclasses with strings
+}
+
+- (void)setNeedsLocalization {
+    objc_setAssociatedObject(self, localizedGenerationKey, nil, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+}
+
+- (NSArray *)viewsWithTruncatedText {
+    NSMutableArray *views = [NSMutableArray array];
+    [self addViewsWithTruncatedTextToArray:views];
+    return views;
+}
+
+- (void)addViewsWithTruncatedTextToArray:(NSMutableArray *)views {
+    if ([self isKindOfClass:[UILabel class]] && !self.hidden) {
+        UILabel *label = (UILabel *)self;
+        if (label.text.length > 0 && !label.adjustsFontSizeToFitWidth) {
+            CGSize size = label.bounds.size;
+            BOOL truncated;
+            if (label.numberOfLines == 1) {
+                CGRect neededRect = [label textRectForBounds:CGRectMake(0, 0, CGFLOAT_MAX, size.height) limitedToNumberOfLines:1];
+                truncated = ceil(neededRect.size.width) > ceil(size.width);
+            } else {
+                CGRect neededRect = [label textRectForBounds:CGRectMake(0, 0, size.width, CGFLOAT_MAX) limitedToNumberOfLines:0];
+                CGRect limitedRect = [label textRectForBounds:CGRectMake(0, 0, size.width, CGFLOAT_MAX) limitedToNumberOfLines:label.numberOfLines];
+                truncated = ceil(neededRect.size.height) > MIN(ceil(limitedRect.size.height), ceil(size.height));
+            }
+            if (truncated) {
+                [views addObject:label];
+            }
+        }
+    }
     for (UIView *subview in self.subviews) {
-        [subview localizeStrings];
+        [subview addViewsWithTruncatedTextToArray:views];
     }
 }
 
@@ -43,11 +412,26 @@ NSString *INLocalizeString(NSString *string) {
 @implementation UIButton (ILocalize)
 
 - (void)localizeStrings {
-    [super localizeStrings];
-    [self setTitle:INLocalizeString([self titleForState:UIControlStateNormal]) forState:UIControlStateNormal];
-    [self setTitle:INLocalizeString([self titleForState:UIControlStateHighlighted]) forState:UIControlStateHighlighted];
-    [self setTitle:INLocalizeString([self titleForState:UIControlStateDisabled]) forState:UIControlStateDisabled];
-    [self setTitle:INLocalizeString([self titleForState:UIControlStateSelected]) forState:UIControlStateSelected];
+    // the title label is managed by the button, so localizing it too would look up the translated title as key
+    INLocalizeView(self, INButtonManagesSubview);
+}
+
+- (void)localizeOwnStrings {
+    static NSString * const propertyNames[] = {@"title.normal", @"title.highlighted", @"title.disabled", @"title.selected"};
+    UIControlState states[] = {UIControlStateNormal, UIControlStateHighlighted, UIControlStateDisabled, UIControlStateSelected};
+    NSUInteger const numberOfStates = sizeof(states) / sizeof(states[0]);
+    
+    // get all titles before setting any, because unset titles fall back to the normal state's title
+    NSString *titles[sizeof(states) / sizeof(states[0])];
+    for (NSUInteger index = 0; index < numberOfStates; index++) {
+        titles[index] = [self titleForState:states[index]];
+    }
+    for (NSUInteger index = 0; index < numberOfStates; index++) {
+        NSString *localizedTitle = INLocalizedStringForProperty(self, propertyNames[index], titles[index]);
+        if (INLocalizedStringDiffers(titles[index], localizedTitle)) {
+            [self setTitle:localizedTitle forState:states[index]];
+        }
+    }
 }
 
 @end
@@ -55,9 +439,11 @@ NSString *INLocalizeString(NSString *string) {
 
 @implementation UILabel (INLocalize)
 
-- (void)localizeStrings {
-    [super localizeStrings];
-    self.text = INLocalizeString(self.text);
+- (void)localizeOwnStrings {
+    NSString *text = INLocalizedStringForProperty(self, INLocalizedPropertyText, self.text);
+    if (INLocalizedStringDiffers(self.text, text)) {
+        self.text = text;
+    }
 }
 
 @end
@@ -65,9 +451,11 @@ NSString *INLocalizeString(NSString *string) {
 
 @implementation UITextView (INLocalize)
 
-- (void)localizeStrings {
-    [super localizeStrings];
-    self.text = INLocalizeString(self.text);
+- (void)localizeOwnStrings {
+    NSString *text = INLocalizedStringForProperty(self, INLocalizedPropertyText, self.text);
+    if (INLocalizedStringDiffers(self.text, text)) {
+        self.text = text;
+    }
 }
 
 @end
@@ -76,9 +464,19 @@ NSString *INLocalizeString(NSString *string) {
 @implementation UITextField (INLocalize)
 
 - (void)localizeStrings {
-    [super localizeStrings];
-    self.text = INLocalizeString(self.text);
-    self.placeholder = INLocalizeString(self.placeholder);
+    // the placeholder label is managed by the text field
+    INLocalizeView(self, INTextFieldManagesSubview);
+}
+
+- (void)localizeOwnStrings {
+    NSString *text = INLocalizedStringForProperty(self, INLocalizedPropertyText, self.text);
+    if (INLocalizedStringDiffers(self.text, text)) {
+        self.text = text;
+    }
+    NSString *placeholder = INLocalizedStringForProperty(self, INLocalizedPropertyPlaceholder, self.placeholder);
+    if (INLocalizedStringDiffers(self.placeholder, placeholder)) {
+        self.placeholder = placeholder;
+    }
 }
 
 @end
@@ -87,11 +485,17 @@ NSString *INLocalizeString(NSString *string) {
 @implementation UISegmentedControl (INLocalize)
 
 - (void)localizeStrings {
-    [super localizeStrings];
-    
+    // the segment labels are managed by the control
+    INLocalizeView(self, INControlManagesSubview);
+}
+
+- (void)localizeOwnStrings {
     for (NSUInteger index = 0; index < self.numberOfSegments; index++) {
-        NSString *newTitle = INLocalizeString([self titleForSegmentAtIndex:index]);
-        [self setTitle:newTitle forSegmentAtIndex:index];
+        NSString *title = [self titleForSegmentAtIndex:index];
+        NSString *newTitle = INLocalizedStringForProperty(self, @(index), title);
+        if (INLocalizedStringDiffers(title, newTitle)) {
+            [self setTitle:newTitle forSegmentAtIndex:index];
+        }
     }
 }
 
@@ -101,10 +505,23 @@ NSString *INLocalizeString(NSString *string) {
 @implementation UISearchBar (INLocalize)
 
 - (void)localizeStrings {
-    [super localizeStrings];
-    self.text = INLocalizeString(self.text);
-    self.placeholder = INLocalizeString(self.placeholder);
-    self.prompt = INLocalizeString(self.prompt);
+    // the text field and labels are managed by the search bar
+    INLocalizeView(self, INControlManagesSubview);
+}
+
+- (void)localizeOwnStrings {
+    NSString *text = INLocalizedStringForProperty(self, INLocalizedPropertyText, self.text);
+    if (INLocalizedStringDiffers(self.text, text)) {
+        self.text = text;
+    }
+    NSString *placeholder = INLocalizedStringForProperty(self, INLocalizedPropertyPlaceholder, self.placeholder);
+    if (INLocalizedStringDiffers(self.placeholder, placeholder)) {
+        self.placeholder = placeholder;
+    }
+    NSString *prompt = INLocalizedStringForProperty(self, INLocalizedPropertyPrompt, self.prompt);
+    if (INLocalizedStringDiffers(self.prompt, prompt)) {
+        self.prompt = prompt;
+    }
 }
 
 @end
@@ -123,8 +540,17 @@ NSString *INLocalizeString(NSString *string) {
 @implementation UINavigationItem (INLocalize)
 
 - (void)localizeStrings {
-    self.title = INLocalizeString(self.title);
-    self.prompt = INLocalizeString(self.prompt);
+    if (INLocalizedGenerationIsCurrent(self)) {
+        return;
+    }
+    NSString *title = INLocalizedStringForProperty(self, INLocalizedPropertyTitle, self.title);
+    if (INLocalizedStringDiffers(self.title, title)) {
+        self.title = title;
+    }
+    NSString *prompt = INLocalizedStringForProperty(self, INLocalizedPropertyPrompt, self.prompt);
+    if (INLocalizedStringDiffers(self.prompt, prompt)) {
+        self.prompt = prompt;
+    }
     [self.leftBarButtonItem localizeStrings];
     [self.rightBarButtonItem localizeStrings];
 }
@@ -135,57 +561,727 @@ NSString *INLocalizeString(NSString *string) {
 @implementation UIBarItem (INLocalize)
 
 - (void)localizeStrings {
-    self.title = INLocalizeString(self.title);
+    if (INLocalizedGenerationIsCurrent(self)) {
+        return;
+    }
+    NSString *title = INLocalizedStringForProperty(self, INLocalizedPropertyTitle, self.title);
+    if (INLocalizedStringDiffers(self.title, title)) {
+        self.title = title;
+    }
 }
 
 @end
 
 
 
-@interface INLocalizer ()
+#pragma mark - Pseudo localization
+
+// The character used for expanding pseudo localized strings.
+static unichar const INPseudoLocalizationExpansionCharacter = 0x00B7; // middle dot
+
+// Returns the accented version of an ASCII letter or the character itself.
+static unichar INPseudoLocalizationAccentedCharacter(unichar character) {
+    switch (character) {
+        case 'a': return 0x00E1;
+        case 'A': return 0x00C5;
+        case 'c': return 0x00E7;
+        case 'C': return 0x00C7;
+        case 'e': return 0x00E9;
+        case 'E': return 0x00C9;
+        case 'i': return 0x00EE;
+        case 'I': return 0x00CE;
+        case 'n': return 0x00F1;
+        case 'N': return 0x00D1;
+        case 'o': return 0x00F6;
+        case 'O': return 0x00D6;
+        case 's': return 0x0161;
+        case 'S': return 0x0160;
+        case 'u': return 0x00FC;
+        case 'U': return 0x00DC;
+        case 'y': return 0x00FD;
+        case 'Y': return 0x00DD;
+        case 'z': return 0x017E;
+        case 'Z': return 0x017D;
+        default: return character;
+    }
+}
+
+// The state of pseudo localizing a string, which maps each character of the input to one character of the output.
+typedef struct {
+    const unichar *characters;
+    NSUInteger length;
+    NSUInteger position;
+    unichar *result;
+    NSUInteger resultLength;
+    BOOL accents;
+    BOOL inPlaceholder;
+} INPseudoLocalizer;
+
+// Copies the current character unchanged.
+static void INPseudoLocalizeKeep(INPseudoLocalizer *localizer) {
+    localizer->result[localizer->resultLength++] = localizer->characters[localizer->position++];
+}
+
+// Copies the current character of a visible text, accented unless it's part of a placeholder like '%@' or '%1$d'.
+static void INPseudoLocalizeText(INPseudoLocalizer *localizer) {
+    unichar character = localizer->characters[localizer->position++];
+    if (character == '%') {
+        // a placeholder ends with its conversion letter, '%%' is no placeholder
+        localizer->inPlaceholder = !localizer->inPlaceholder;
+    } else if (localizer->inPlaceholder && ((character >= 'a' && character <= 'z') || (character >= 'A' && character <= 'Z') || character == '@')) {
+        localizer->inPlaceholder = (character == 'l' || character == 'h' || character == 'q' || character == 'L' || character == 'z' || character == 't' || character == 'j');
+    } else if (!localizer->inPlaceholder && localizer->accents) {
+        character = INPseudoLocalizationAccentedCharacter(character);
+    }
+    localizer->result[localizer->resultLength++] = character;
+}
+
+// Returns true if the characters in the range, without surrounding whitespace, are the given ASCII keyword.
+static BOOL INPseudoLocalizeIsKeyword(INPseudoLocalizer *localizer, NSUInteger start, NSUInteger end, const char *keyword) {
+    while (start < end && localizer->characters[start] == ' ') {
+        start++;
+    }
+    while (end > start && localizer->characters[end - 1] == ' ') {
+        end--;
+    }
+    NSUInteger keywordLength = strlen(keyword);
+    if (end - start != keywordLength) {
+        return NO;
+    }
+    for (NSUInteger index = 0; index < keywordLength; index++) {
+        if (localizer->characters[start + index] != (unichar)keyword[index]) {
+            return NO;
+        }
+    }
+    return YES;
+}
+
+static void INPseudoLocalizeArgument(INPseudoLocalizer *localizer);
+
+// Pseudo localizes a message up to the end of the string or up to the closing brace of a nested message, which will not be consumed.
+static void INPseudoLocalizeMessage(INPseudoLocalizer *localizer, BOOL nested, BOOL inPlural) {
+    while (localizer->position < localizer->length) {
+        unichar character = localizer->characters[localizer->position];
+        unichar next = (localizer->position + 1 < localizer->length) ? localizer->characters[localizer->position + 1] : 0;
+        if (character == '\'' && next == '\'') {
+            // a doubled apostrophe is a single one
+            INPseudoLocalizeKeep(localizer);
+            INPseudoLocalizeKeep(localizer);
+        } else if (character == '\'' && (next == '{' || next == '}' || (inPlural && next == '#'))) {
+            // quoted literal text up to the next single apostrophe, its braces are no arguments
+            INPseudoLocalizeKeep(localizer);
+            while (localizer->position < localizer->length) {
+                if (localizer->characters[localizer->position] == '\'') {
+                    BOOL doubled = localizer->position + 1 < localizer->length && localizer->characters[localizer->position + 1] == '\'';
+                    INPseudoLocalizeKeep(localizer);
+                    if (!doubled) {
+                        break;
+                    }
+                    INPseudoLocalizeKeep(localizer);
+                } else {
+                    INPseudoLocalizeText(localizer);
+                }
+            }
+        } else if (character == '{') {
+            INPseudoLocalizeArgument(localizer);
+        } else if (character == '}' && nested) {
+            return;
+        } else if (character == '#' && inPlural) {
+            INPseudoLocalizeKeep(localizer);
+        } else {
+            INPseudoLocalizeText(localizer);
+        }
+    }
+}
+
+// Pseudo localizes an argument starting with its opening brace, only the sub-messages of plural and select arguments are visible texts.
+static void INPseudoLocalizeArgument(INPseudoLocalizer *localizer) {
+    // the argument's name and type are kept
+    INPseudoLocalizeKeep(localizer);
+    NSUInteger fieldStart = localizer->position;
+    NSUInteger fieldIndex = 0;
+    BOOL hasMessages = NO;
+    BOOL inPlural = NO;
+    NSUInteger depth = 0;
+    while (localizer->position < localizer->length) {
+        unichar character = localizer->characters[localizer->position];
+        if (character == '}') {
+            INPseudoLocalizeKeep(localizer);
+            if (depth == 0) {
+                return;
+            }
+            depth--;
+        } else if (character == '{' && !hasMessages) {
+            // the braces of an unknown argument type are kept with everything in them
+            INPseudoLocalizeKeep(localizer);
+            depth++;
+        } else if (character == ',' && !hasMessages && depth == 0) {
+            if (fieldIndex == 1) {
+                // after the type follow the selectors with their messages or a style without any, like INMessageFormat only plural and select have messages
+                inPlural = INPseudoLocalizeIsKeyword(localizer, fieldStart, localizer->position, "plural");
+                hasMessages = inPlural || INPseudoLocalizeIsKeyword(localizer, fieldStart, localizer->position, "select");
+            }
+            fieldIndex++;
+            INPseudoLocalizeKeep(localizer);
+            fieldStart = localizer->position;
+        } else if (character == '{' && hasMessages) {
+            INPseudoLocalizeKeep(localizer);
+            INPseudoLocalizeMessage(localizer, YES, inPlural);
+            if (localizer->position < localizer->length) {
+                INPseudoLocalizeKeep(localizer);
+            }
+        } else {
+            INPseudoLocalizeKeep(localizer);
+        }
+    }
+}
 
+NSString *INPseudoLocalizeString(NSString *string, INPseudoLocalization pseudoLocalization, NSUInteger expansion) {
+    NSUInteger length = string.length;
+    NSUInteger expansionLength = 0;
+    if ((pseudoLocalization & INPseudoLocalizationExpansion) && expansion > 0) {
+        expansionLength = (length * expansion + 99) / 100;
+    }
+    
+    // each character is mapped to exactly one, so the result's length is known beforehand
+    unichar *characters = malloc((2 * length + expansionLength + 4) * sizeof(unichar));
+    if (characters == NULL) {
+        return string;
+    }
+    unichar *result = characters + length;
+    [string getCharacters:characters range:NSMakeRange(0, length)];
+    INPseudoLocalizer localizer = {characters, length, 0, result, 0, (pseudoLocalization & INPseudoLocalizationAccents) != 0, NO};
+    
+    if (pseudoLocalization & INPseudoLocalizationBrackets) {
+        result[localizer.resultLength++] = '[';
+    }
+    INPseudoLocalizeMessage(&localizer, NO, NO);
+    if (expansionLength > 0) {
+        result[localizer.resultLength++] = ' ';
+        for (NSUInteger index = 0; index < expansionLength; index++) {
+            result[localizer.resultLength++] = INPseudoLocalizationExpansionCharacter;
+        }
+    }
+    if (pseudoLocalization & INPseudoLocalizationBrackets) {
+        result[localizer.resultLength++] = ']';
+    }
+    
+    NSString *pseudoString = [NSString stringWithCharacters:result length:localizer.resultLength];
+    free(characters);
+    return pseudoString;
+}
+
+
+// The number of recently used tables kept alive by the shared cache even without any localizer using them.
+static NSUInteger const INLocalizationTableCacheCountLimit = 8;
+
+
+/*
+ The immutable localization data of one language: the strings table and the compiled message formats.
+ 
+ Tables are shared by all localizers using the same language through a cache which only references them weakly,
+ so a table lives as long as any localizer uses it or it's one of the recently used ones.
+ */
+@interface INLocalizationTable : NSObject
+
+@property (nonatomic, copy, readonly) NSString *language;
+@property (nonatomic, strong, readonly) NSBundle *bundle;
+
+// Either an NSDictionary or an INCompiledStringsTable, both are accessed only by subscripting.
+// When the language has fallback languages, this is a dictionary with the strings of all of them merged.
+@property (nonatomic, strong, readonly) id strings;
+
+// The keys of the merged strings missing in each language of the fallback chain, language -> NSSet.
+@property (nonatomic, strong, readonly) NSDictionary *missingKeysByLanguage;
+
+// The compiled message formats by their patterns, NSNull for invalid patterns.
+@property (nonatomic, strong, readonly) NSCache *messageFormats;
+
+// The generation of the fallback and pseudo localization settings the table has been loaded with.
+@property (nonatomic, assign, readonly) NSUInteger settingsGeneration;
+
++ (instancetype)tableForLanguage:(NSString *)language;
++ (void)preloadLanguages:(NSArray *)languages completion:(void (^)(void))completion;
++ (void)setPseudoLocalization:(INPseudoLocalization)pseudoLocalization expansion:(NSUInteger)percent;
++ (void)setFallbackLanguages:(NSArray *)fallbackLanguages forLanguage:(NSString *)language;
+
+- (NSString *)localizeString:(NSString *)string;
+- (NSString *)localizeFormat:(NSString *)key arguments:(NSArray *)arguments;
+
+@end
+
+
+@interface INLocalizationTable ()
+
+@property (nonatomic, copy, readwrite) NSString *language;
 @property (nonatomic, strong, readwrite) NSBundle *bundle;
+@property (nonatomic, strong, readwrite) id strings;
+@property (nonatomic, strong, readwrite) NSDictionary *missingKeysByLanguage;
+@property (nonatomic, strong, readwrite) NSCache *messageFormats;
+@property (nonatomic, assign, readwrite) NSUInteger settingsGeneration;
 
 @end
 
 
-@implementation INLocalizer
+@implementation INLocalizationTable
 
-INSingletonDefinition
+static NSMapTable *__sharedTables = nil; // language -> weakly referenced table
+static NSCache *__recentTables = nil; // language -> strongly referenced table
+static NSMutableDictionary *__preloadedTables = nil; // language -> table kept until the fallbacks change
+static NSMutableDictionary *__loadingGroups = nil; // language -> dispatch group left when the loading thread has published the table
+static NSUInteger __settingsGeneration = 1; // increased with each change of the settings, so tables loaded with older ones are not shared
+static NSDictionary *__fallbackLanguages = nil; // language or NSNull for all -> array of languages
+static INPseudoLocalization __pseudoLocalization = INPseudoLocalizationNone;
+static NSUInteger __pseudoLocalizationExpansion = 0; // in percent
+static dispatch_semaphore_t __sharedTablesLock = NULL;
 
-- (id)init {
++ (void)initialize {
+    if (self != [INLocalizationTable class]) {
+        return;
+    }
+    __sharedTables = [NSMapTable strongToWeakObjectsMapTable];
+    __recentTables = [[NSCache alloc] init];
+    __recentTables.countLimit = INLocalizationTableCacheCountLimit;
+    __preloadedTables = [NSMutableDictionary dictionary];
+    __loadingGroups = [NSMutableDictionary dictionary];
+    __fallbackLanguages = [NSDictionary dictionary];
+    __sharedTablesLock = dispatch_semaphore_create(1);
+}
+
++ (void)setFallbackLanguages:(NSArray *)fallbackLanguages forLanguage:(NSString *)language {
+    id key = language != nil ? language : [NSNull null];
+    dispatch_semaphore_wait(__sharedTablesLock, DISPATCH_TIME_FOREVER);
+    NSMutableDictionary *allFallbackLanguages = [__fallbackLanguages mutableCopy];
+    if (fallbackLanguages != nil) {
+        allFallbackLanguages[key] = [fallbackLanguages copy];
+    } else {
+        [allFallbackLanguages removeObjectForKey:key];
+    }
+    __fallbackLanguages = [allFallbackLanguages copy];
+    // the loaded tables are merged with the old fallbacks
+    [self removeAllTables];
+    dispatch_semaphore_signal(__sharedTablesLock);
+}
+
++ (void)setPseudoLocalization:(INPseudoLocalization)pseudoLocalization expansion:(NSUInteger)percent {
+    dispatch_semaphore_wait(__sharedTablesLock, DISPATCH_TIME_FOREVER);
+    __pseudoLocalization = pseudoLocalization;
+    __pseudoLocalizationExpansion = percent;
+    // the loaded tables have been transformed with the old settings
+    [self removeAllTables];
+    dispatch_semaphore_signal(__sharedTablesLock);
+}
+
+// Removes all tables from the caches, has to be called within the lock.
++ (void)removeAllTables {
+    __settingsGeneration++;
+    [__sharedTables removeAllObjects];
+    [__recentTables removeAllObjects];
+    [__preloadedTables removeAllObjects];
+    // tables still loading use the old settings, so the next request has to load its own
+    [__loadingGroups removeAllObjects];
+}
+
+// Returns the queue for loading tables in the background.
++ (dispatch_queue_t)preloadQueue {
+#ifdef QOS_CLASS_UTILITY
+    // unknown before iOS 8, where no queue is returned
+    dispatch_queue_t queue = dispatch_get_global_queue(QOS_CLASS_UTILITY, 0);
+    if (queue != NULL) {
+        return queue;
+    }
+#endif
+    return dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_LOW, 0);
+}
+
++ (NSArray *)fallbackChainForLanguage:(NSString *)language {
+    NSMutableArray *chain = [NSMutableArray array];
+    
+    // the language itself followed by its more general ones, i.e. "zh-Hans-CN", "zh-Hans", "zh"
+    NSCharacterSet *separators = [NSCharacterSet characterSetWithCharactersInString:@"-_"];
+    NSString *generalLanguage = language;
+    while (generalLanguage.length > 0) {
+        [chain addObject:generalLanguage];
+        NSRange separatorRange = [generalLanguage rangeOfCharacterFromSet:separators options:NSBackwardsSearch];
+        if (separatorRange.location == NSNotFound) {
+            break;
+        }
+        generalLanguage = [generalLanguage substringToIndex:separatorRange.location];
+    }
+    
+    // then the configured fallbacks of the language or those for all languages
+    dispatch_semaphore_wait(__sharedTablesLock, DISPATCH_TIME_FOREVER);
+    NSArray *fallbackLanguages = __fallbackLanguages[language];
+    if (fallbackLanguages == nil) {
+        fallbackLanguages = __fallbackLanguages[[NSNull null]];
+    }
+    dispatch_semaphore_signal(__sharedTablesLock);
+    for (NSString *fallbackLanguage in fallbackLanguages) {
+        if (![chain containsObject:fallbackLanguage]) {
+            [chain addObject:fallbackLanguage];
+        }
+    }
+    return chain;
+}
+
++ (instancetype)tableForLanguage:(NSString *)language {
+    id cacheKey = language != nil ? language : [NSNull null];
+    
+    INLocalizationTable *table = nil;
+    dispatch_group_t loadingGroup = nil;
+    while (YES) {
+        dispatch_semaphore_wait(__sharedTablesLock, DISPATCH_TIME_FOREVER);
+        table = [__sharedTables objectForKey:cacheKey];
+        loadingGroup = __loadingGroups[cacheKey];
+        if (table != nil || loadingGroup == nil) {
+            break;
+        }
+        dispatch_semaphore_signal(__sharedTablesLock);
+        // an other thread is already loading the language, i.e. a preload, so wait for its table instead of loading it twice
+        dispatch_group_wait(loadingGroup, DISPATCH_TIME_FOREVER);
+    }
+    if (table != nil) {
+        dispatch_semaphore_signal(__sharedTablesLock);
+        [__recentTables setObject:table forKey:cacheKey];
+        return table;
+    }
+    loadingGroup = dispatch_group_create();
+    dispatch_group_enter(loadingGroup);
+    __loadingGroups[cacheKey] = loadingGroup;
+    NSUInteger settingsGeneration = __settingsGeneration;
+    dispatch_semaphore_signal(__sharedTablesLock);
+    
+    // load outside of the lock, so other languages are not blocked meanwhile
+    table = [[self alloc] initWithLanguage:language];
+    table.settingsGeneration = settingsGeneration;
+    
+    // a table loaded with settings which have changed meanwhile is only used by this caller
+    dispatch_semaphore_wait(__sharedTablesLock, DISPATCH_TIME_FOREVER);
+    BOOL current = (settingsGeneration == __settingsGeneration);
+    if (current) {
+        [__sharedTables setObject:table forKey:cacheKey];
+    }
+    if (__loadingGroups[cacheKey] == loadingGroup) {
+        [__loadingGroups removeObjectForKey:cacheKey];
+    }
+    dispatch_semaphore_signal(__sharedTablesLock);
+    dispatch_group_leave(loadingGroup);
+    if (current) {
+        [__recentTables setObject:table forKey:cacheKey];
+    }
+    return table;
+}
+
++ (void)preloadLanguages:(NSArray *)languages completion:(void (^)(void))completion {
+    NSArray *languagesToLoad = [languages copy];
+    dispatch_async([self preloadQueue], ^{
+        for (NSString *language in languagesToLoad) {
+            // loading publishes the table to the shared cache, but only after it's completely loaded
+            INLocalizationTable *table = [self tableForLanguage:language];
+            if ([table.strings isKindOfClass:[INCompiledStringsTable class]]) {
+                [table.strings warmUp];
+            }
+            // the settings may have changed while loading, then the table is outdated and must not be kept
+            dispatch_semaphore_wait(__sharedTablesLock, DISPATCH_TIME_FOREVER);
+            if (table.settingsGeneration == __settingsGeneration) {
+                __preloadedTables[(language != nil ? language : [NSNull null])] = table;
+            }
+            dispatch_semaphore_signal(__sharedTablesLock);
+        }
+        if (completion != nil) {
+            dispatch_async(dispatch_get_main_queue(), completion);
+        }
+    });
+}
+
++ (id)stringsOfBundle:(NSBundle *)bundle {
+    // prefer a compiled table which only needs to be mapped into memory
+    NSString *compiledPath = [bundle pathForResource:INLocalizerStringsTableName ofType:INCompiledStringsTableFileExtension];
+    INCompiledStringsTable *compiledTable = [INCompiledStringsTable tableWithContentsOfFile:compiledPath];
+    if (compiledTable != nil) {
+        return compiledTable;
+    }
+    
+    // fall back to the strings file,
+    // the bundle resolves the table of its preferred localization when it's not a language bundle itself
+    NSString *path = [bundle pathForResource:INLocalizerStringsTableName ofType:@"strings"];
+    NSDictionary *table = nil;
+    if (path != nil) {
+        // handles both, old-style and binary plist strings files
+        table = [NSDictionary dictionaryWithContentsOfFile:path];
+    }
+    if (table == nil) {
+        return [NSDictionary dictionary];
+    }
+    // an immutable copy with copied keys, so lookups never touch mutable state
+    return [table copy];
+}
+
+- (instancetype)initWithLanguage:(NSString *)language {
     self = [super init];
     if (self == nil) return self;
     
-    self.bundle = [NSBundle mainBundle];
+    if (language == nil) {
+        language = [[[NSBundle mainBundle] preferredLocalizations] firstObject];
+    }
+    
+    // get the bundles of all available languages in the fallback chain
+    NSMutableArray *languages = [NSMutableArray array];
+    NSMutableArray *bundles = [NSMutableArray array];
+    for (NSString *chainLanguage in [INLocalizationTable fallbackChainForLanguage:language]) {
+        NSString *path = [[NSBundle mainBundle] pathForResource:chainLanguage ofType:@"lproj"];
+        if (path != nil) {
+            [languages addObject:chainLanguage];
+            [bundles addObject:[NSBundle bundleWithPath:path]];
+        }
+    }
+    
+	if (bundles.count == 0) {
+		// none of the languages exist, use the main bundle's language
+        self.bundle = [NSBundle mainBundle];
+        self.language = [[self.bundle preferredLocalizations] firstObject];
+        self.strings = [INLocalizationTable stringsOfBundle:self.bundle];
+        self.missingKeysByLanguage = [NSDictionary dictionary];
+	} else if (bundles.count == 1) {
+        // no fallbacks to merge, so a compiled table can be used directly
+        self.bundle = bundles[0];
+        self.language = languages[0];
+        self.strings = [INLocalizationTable stringsOfBundle:self.bundle];
+        self.missingKeysByLanguage = @{self.language: [NSSet set]};
+    } else {
+        self.bundle = bundles[0];
+        self.language = languages[0];
+        [self mergeStringsOfBundles:bundles languages:languages];
+    }
+    
+    // transform the translations once here instead of with each lookup
+    dispatch_semaphore_wait(__sharedTablesLock, DISPATCH_TIME_FOREVER);
+    INPseudoLocalization pseudoLocalization = __pseudoLocalization;
+    NSUInteger expansion = __pseudoLocalizationExpansion;
+    dispatch_semaphore_signal(__sharedTablesLock);
+    if (pseudoLocalization != INPseudoLocalizationNone) {
+        [self pseudoLocalizeStrings:pseudoLocalization expansion:expansion];
+    }
+    
+    self.messageFormats = [[NSCache alloc] init];
     
     return self;
 }
 
-- (void)setLanguage:(NSString *)language {
-	NSString *path = nil;
-    if (language != nil) {
-        path = [[NSBundle mainBundle] pathForResource:language ofType:@"lproj"];
+// Merges the strings of all bundles into one table so a lookup is still a single hash lookup, the first bundle's strings win.
+- (void)mergeStringsOfBundles:(NSArray *)bundles languages:(NSArray *)languages {
+    NSMutableArray *allStrings = [NSMutableArray arrayWithCapacity:bundles.count];
+    NSMutableDictionary *mergedStrings = [NSMutableDictionary dictionary];
+    for (NSBundle *bundle in [bundles reverseObjectEnumerator]) {
+        id strings = [INLocalizationTable stringsOfBundle:bundle];
+        if ([strings isKindOfClass:[INCompiledStringsTable class]]) {
+            strings = [strings dictionaryRepresentation];
+        }
+        [allStrings insertObject:strings atIndex:0];
+        [mergedStrings addEntriesFromDictionary:strings];
     }
-	if (path == nil) {
-		// the desired language does not exist, reset localizer
-        self.bundle = [NSBundle mainBundle];
-	} else {
-        // load new bundle with the desired language
-		self.bundle = [NSBundle bundleWithPath:path];
+    
+    // remember which keys are only available by a fallback
+    NSMutableDictionary *missingKeysByLanguage = [NSMutableDictionary dictionaryWithCapacity:languages.count];
+    [languages enumerateObjectsUsingBlock:^(NSString *language, NSUInteger index, BOOL *stop) {
+        NSDictionary *strings = allStrings[index];
+        NSMutableSet *missingKeys = [NSMutableSet set];
+        for (NSString *key in mergedStrings) {
+            if (strings[key] == nil) {
+                [missingKeys addObject:key];
+            }
+        }
+        missingKeysByLanguage[language] = [missingKeys copy];
+    }];
+    
+    self.strings = [mergedStrings copy];
+    self.missingKeysByLanguage = [missingKeysByLanguage copy];
+}
+
+- (void)pseudoLocalizeStrings:(INPseudoLocalization)pseudoLocalization expansion:(NSUInteger)expansion {
+    id strings = self.strings;
+    if ([strings isKindOfClass:[INCompiledStringsTable class]]) {
+        strings = [strings dictionaryRepresentation];
+    }
+    NSMutableDictionary *pseudoStrings = [NSMutableDictionary dictionaryWithCapacity:[strings count]];
+    for (NSString *key in strings) {
+        pseudoStrings[key] = INPseudoLocalizeString(strings[key], pseudoLocalization, expansion);
     }
+    self.strings = [pseudoStrings copy];
 }
 
 - (NSString *)localizeString:(NSString *)string {
     if (string == nil) {
         return nil;
     }
-	return [self.bundle localizedStringForKey:string value:string table:nil];
+    NSString *localizedString = self.strings[string];
+    if (__instrumentationEnabled) {
+        INLocalizerRecordLookup(string, localizedString == nil || [localizedString isEqualToString:string]);
+    }
+	return localizedString != nil ? localizedString : string;
+}
+
+- (NSString *)localizeFormat:(NSString *)key arguments:(NSArray *)arguments {
+    NSString *pattern = [self localizeString:key];
+    if (pattern == nil) {
+        return nil;
+    }
+    
+    // compile each pattern only once per language
+    id format = [self.messageFormats objectForKey:pattern];
+    if (format == nil) {
+        format = [INMessageFormat messageFormatWithPattern:pattern];
+        if (format == nil) {
+            DLog(@"INLocalizer: invalid message format for key '%@': %@", key, pattern);
+            format = [NSNull null];
+        }
+        [self.messageFormats setObject:format forKey:pattern];
+    }
+    if (format == [NSNull null]) {
+        return pattern;
+    }
+    
+    // format into a buffer which is reused by each call on the same thread
+    NSMutableDictionary *threadDictionary = [[NSThread currentThread] threadDictionary];
+    NSMutableString *buffer = threadDictionary[INLocalizerMessageBufferKey];
+    if (buffer == nil) {
+        buffer = [NSMutableString string];
+        threadDictionary[INLocalizerMessageBufferKey] = buffer;
+    }
+    [buffer setString:@""];
+    [format appendToString:buffer arguments:arguments language:self.language];
+    return [buffer copy];
+}
+
+@end
+
+
+
+@interface INLocalizer ()
+
+@property (atomic, assign, readwrite) NSUInteger languageGeneration;
+
+// The table of the current language, swapped as a whole when the language changes.
+@property (atomic, strong) INLocalizationTable *table;
+
+@end
+
+
+@implementation INLocalizer
+
+INSingletonDefinition
+
+- (id)init {
+    return [self initWithLanguage:nil];
+}
+
+- (instancetype)initWithLanguage:(NSString *)language {
+    self = [super init];
+    if (self == nil) return self;
+    
+    self.table = [INLocalizationTable tableForLanguage:language];
+    self.languageGeneration = 1;
+    
+    return self;
+}
+
+- (NSBundle *)bundle {
+    return self.table.bundle;
+}
+
+- (NSString *)language {
+    return self.table.language;
+}
+
+- (NSDictionary *)missingKeysByLanguage {
+    return self.table.missingKeysByLanguage;
+}
+
++ (void)setFallbackLanguages:(NSArray *)fallbackLanguages forLanguage:(NSString *)language {
+    [INLocalizationTable setFallbackLanguages:fallbackLanguages forLanguage:language];
+}
+
++ (void)preloadLanguages:(NSArray *)languages completion:(void (^)(void))completion {
+    [INLocalizationTable preloadLanguages:languages completion:completion];
+}
+
++ (void)setPseudoLocalization:(INPseudoLocalization)pseudoLocalization expansion:(NSUInteger)percent {
+    [INLocalizationTable setPseudoLocalization:pseudoLocalization expansion:percent];
+}
+
+
+#pragma mark - Localizing
+
+- (void)setLanguage:(NSString *)language {
+    // the table is completely loaded before publishing it, so lookups on other threads never see a partially loaded language
+    INLocalizationTable *table = [INLocalizationTable tableForLanguage:language];
+    // swap the table and count the generation within one lock, so concurrent calls never publish the same generation
+    @synchronized (self) {
+        if (table == self.table) {
+            // the shared table of the same language as before, so there is nothing to re-localize
+            return;
+        }
+        self.table = table;
+        self.languageGeneration = self.languageGeneration + 1;
+    }
+}
+
+- (NSString *)localizeString:(NSString *)string {
+    return [self.table localizeString:string];
 }
 
 + (NSString *)localizeString:(NSString *)string {
     return [[INLocalizer sharedInstance] localizeString:string];
 }
 
++ (NSString *)localizeString:(NSString *)string language:(NSString *)language {
+    return [[INLocalizationTable tableForLanguage:language] localizeString:string];
+}
+
+- (NSString *)localizeFormat:(NSString *)key arguments:(NSArray *)arguments {
+    return [self.table localizeFormat:key arguments:arguments];
+}
+
++ (NSString *)localizeFormat:(NSString *)key arguments:(NSArray *)arguments {
+    return [[INLocalizer sharedInstance] localizeFormat:key arguments:arguments];
+}
+
++ (NSString *)localizeFormat:(NSString *)key arguments:(NSArray *)arguments language:(NSString *)language {
+    return [[INLocalizationTable tableForLanguage:language] localizeFormat:key arguments:arguments];
+}
+
+
+#pragma mark - Instrumentation
+
++ (BOOL)isInstrumentationEnabled {
+    return __instrumentationEnabled;
+}
+
++ (void)setInstrumentationEnabled:(BOOL)enabled {
+    __instrumentationEnabled = enabled;
+}
+
++ (void)resetInstrumentation {
+    [INLocalizerStatistics reset];
+}
+
++ (NSDictionary *)instrumentationReport {
+    // the keys of the singleton's table for finding keys which have never been looked up
+    id strings = [[[INLocalizer sharedInstance] table] strings];
+    NSMutableArray *allKeys = [NSMutableArray array];
+    if ([strings isKindOfClass:[INCompiledStringsTable class]]) {
+        [strings enumerateKeysAndObjectsUsingBlock:^(NSString *key, NSString *value, BOOL *stop) {
+            [allKeys addObject:key];
+        }];
+    } else {
+        [allKeys addObjectsFromArray:[strings allKeys]];
+    }
+    return [INLocalizerStatistics mergedReportWithKeys:allKeys];
+}
+
++ (NSData *)instrumentationReportJSON {
+    return [NSJSONSerialization dataWithJSONObject:[self instrumentationReport] options:NSJSONWritingPrettyPrinted error:NULL];
+}
+
 
 @end
@@ -0,0 +1,111 @@
+// INMessageFormat.h
+//
+// Copyright (c) 2014 Sven Korset
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#import <Foundation/Foundation.h>
+
+
+/// The plural categories of the CLDR plural rules.
+typedef NS_ENUM(NSInteger, INPluralCategory) {
+    INPluralCategoryZero,
+    INPluralCategoryOne,
+    INPluralCategoryTwo,
+    INPluralCategoryFew,
+    INPluralCategoryMany,
+    INPluralCategoryOther,
+};
+
+
+/**
+ Returns the plural category of a number for a language according to the CLDR plural rules.
+ 
+ Supports the rules of the most common languages, any other language gets the English rules.
+ 
+    INPluralCategoryForNumber(@"en", 1) == INPluralCategoryOne
+    INPluralCategoryForNumber(@"fr", 0) == INPluralCategoryOne
+    INPluralCategoryForNumber(@"ru", 3) == INPluralCategoryFew
+ 
+ @param language The ISO language code, i.e. "de" or "pt-BR".
+ @param number The number to get the category for.
+ @return The plural category.
+ */
+INPluralCategory INPluralCategoryForNumber(NSString *language, double number);
+
+
+/**
+ A compiled message pattern in a subset of the ICU message format syntax.
+ 
+ The pattern is parsed only once when creating the instance, formatting walks the compiled nodes.
+ Supported are positional arguments, plural and select arguments and apostrophe quoting:
+ 
+    {0}                                                   the first argument as string
+    {0, plural, =0 {no files} one {# file} other {# files}}  plural categories and exact values, # is the number
+    {0, plural, offset:1 one {you and # other} other {you and # others}}
+    {1, select, male {his} female {her} other {their}}    selected by the argument's string value
+    '{'  ''                                               a quoted brace and an apostrophe
+ 
+ Example:
+ 
+    INMessageFormat *format = [INMessageFormat messageFormatWithPattern:@"{0} has {1, plural, one {# file} other {# files}}"];
+    NSString *message = [format stringWithArguments:@[@"Disk", @3] language:@"en"]; // "Disk has 3 files"
+ 
+ Instances are immutable and may be used from any thread.
+ */
+@interface INMessageFormat : NSObject
+
+
+/**
+ Compiles a pattern.
+ 
+ @param pattern The message pattern.
+ @return The compiled message format or nil if the pattern has a syntax error.
+ */
++ (instancetype)messageFormatWithPattern:(NSString *)pattern;
+
+
+/// The pattern which has been compiled.
+@property (nonatomic, copy, readonly) NSString *pattern;
+
+
+/**
+ Formats the message into a string.
+ 
+ @param arguments The positional arguments, plural arguments have to be NSNumber objects. Missing arguments are formatted as their placeholder.
+ @param language The language code whose plural rules to use.
+ @return The formatted message.
+ */
+- (NSString *)stringWithArguments:(NSArray *)arguments language:(NSString *)language;
+
+
+/**
+ Formats the message and appends it to a given string.
+ 
+ Lets the caller reuse a buffer for formatting many messages.
+ 
+ @param string The mutable string to append the message to.
+ @param arguments The positional arguments, plural arguments have to be NSNumber objects.
+ @param language The language code whose plural rules to use.
+ */
+- (void)appendToString:(NSMutableString *)string arguments:(NSArray *)arguments language:(NSString *)language;
+
+
+@end
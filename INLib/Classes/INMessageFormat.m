@@ -0,0 +1,615 @@
+// INMessageFormat.m
+//
+// Copyright (c) 2014 Sven Korset
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#import "INMessageFormat.h"
+
+
+#pragma mark - Plural rules
+
+// The different plural rule sets, each shared by a couple of languages.
+typedef NS_ENUM(NSInteger, INPluralRule) {
+    INPluralRuleOneOther,       // en, de, nl, sv, it, es, ... : one for 1
+    INPluralRuleOther,          // ja, zh, ko, ... : no plural forms
+    INPluralRuleFrench,         // fr, pt : one for 0 and 1
+    INPluralRuleEastSlavic,     // ru, uk, be : one, few, many
+    INPluralRuleSouthSlavic,    // hr, sr, bs : one, few
+    INPluralRulePolish,         // pl : one, few, many
+    INPluralRuleCzech,          // cs, sk : one, few, many for fractions
+    INPluralRuleRomanian,       // ro : one, few
+    INPluralRuleArabic,         // ar : zero, one, two, few, many
+    INPluralRuleHebrew,         // he : one, two
+};
+
+static INPluralRule INPluralRuleForLanguage(NSString *language) {
+    static NSDictionary *rulesByLanguage = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        rulesByLanguage = @{
+            @"ja": @(INPluralRuleOther), @"zh": @(INPluralRuleOther), @"ko": @(INPluralRuleOther), @"vi": @(INPluralRuleOther),
+            @"th": @(INPluralRuleOther), @"id": @(INPluralRuleOther), @"ms": @(INPluralRuleOther), @"km": @(INPluralRuleOther),
+            @"lo": @(INPluralRuleOther), @"my": @(INPluralRuleOther),
+            @"fr": @(INPluralRuleFrench), @"pt": @(INPluralRuleFrench),
+            @"ru": @(INPluralRuleEastSlavic), @"uk": @(INPluralRuleEastSlavic), @"be": @(INPluralRuleEastSlavic),
+            @"hr": @(INPluralRuleSouthSlavic), @"sr": @(INPluralRuleSouthSlavic), @"bs": @(INPluralRuleSouthSlavic),
+            @"pl": @(INPluralRulePolish),
+            @"cs": @(INPluralRuleCzech), @"sk": @(INPluralRuleCzech),
+            @"ro": @(INPluralRuleRomanian),
+            @"ar": @(INPluralRuleArabic),
+            @"he": @(INPluralRuleHebrew), @"iw": @(INPluralRuleHebrew),
+        };
+    });
+    if (language == nil) {
+        return INPluralRuleOneOther;
+    }
+    // only the language part of a code like "pt-BR" or "de_AT" decides
+    NSRange separatorRange = [language rangeOfCharacterFromSet:[NSCharacterSet characterSetWithCharactersInString:@"-_"]];
+    if (separatorRange.location != NSNotFound) {
+        language = [language substringToIndex:separatorRange.location];
+    }
+    NSNumber *rule = rulesByLanguage[[language lowercaseString]];
+    return rule != nil ? [rule integerValue] : INPluralRuleOneOther;
+}
+
+INPluralCategory INPluralCategoryForNumber(NSString *language, double number) {
+    double absoluteNumber = fabs(number);
+    if (!isfinite(number) || absoluteNumber >= 0x1p64) {
+        // not representable as an integer, so it can't be in any other category
+        return INPluralCategoryOther;
+    }
+    BOOL isInteger = (absoluteNumber == floor(absoluteNumber));
+    unsigned long long integer = (unsigned long long)absoluteNumber;
+    unsigned long long mod10 = integer % 10;
+    unsigned long long mod100 = integer % 100;
+    
+    switch (INPluralRuleForLanguage(language)) {
+        case INPluralRuleOther:
+            return INPluralCategoryOther;
+        case INPluralRuleFrench:
+            return integer <= 1 ? INPluralCategoryOne : INPluralCategoryOther;
+        case INPluralRuleEastSlavic:
+            if (!isInteger) return INPluralCategoryOther;
+            if (mod10 == 1 && mod100 != 11) return INPluralCategoryOne;
+            if (mod10 >= 2 && mod10 <= 4 && (mod100 < 12 || mod100 > 14)) return INPluralCategoryFew;
+            return INPluralCategoryMany;
+        case INPluralRuleSouthSlavic:
+            if (!isInteger) return INPluralCategoryOther;
+            if (mod10 == 1 && mod100 != 11) return INPluralCategoryOne;
+            if (mod10 >= 2 && mod10 <= 4 && (mod100 < 12 || mod100 > 14)) return INPluralCategoryFew;
+            return INPluralCategoryOther;
+        case INPluralRulePolish:
+            if (!isInteger) return INPluralCategoryOther;
+            if (integer == 1) return INPluralCategoryOne;
+            if (mod10 >= 2 && mod10 <= 4 && (mod100 < 12 || mod100 > 14)) return INPluralCategoryFew;
+            return INPluralCategoryMany;
+        case INPluralRuleCzech:
+            if (!isInteger) return INPluralCategoryMany;
+            if (integer == 1) return INPluralCategoryOne;
+            if (integer >= 2 && integer <= 4) return INPluralCategoryFew;
+            return INPluralCategoryOther;
+        case INPluralRuleRomanian:
+            if (!isInteger) return INPluralCategoryFew;
+            if (integer == 1) return INPluralCategoryOne;
+            if (integer == 0 || (mod100 >= 2 && mod100 <= 19)) return INPluralCategoryFew;
+            return INPluralCategoryOther;
+        case INPluralRuleArabic:
+            if (!isInteger) return INPluralCategoryOther;
+            if (integer == 0) return INPluralCategoryZero;
+            if (integer == 1) return INPluralCategoryOne;
+            if (integer == 2) return INPluralCategoryTwo;
+            if (mod100 >= 3 && mod100 <= 10) return INPluralCategoryFew;
+            if (mod100 >= 11) return INPluralCategoryMany;
+            return INPluralCategoryOther;
+        case INPluralRuleHebrew:
+            if (!isInteger) return INPluralCategoryOther;
+            if (integer == 1) return INPluralCategoryOne;
+            if (integer == 2) return INPluralCategoryTwo;
+            return INPluralCategoryOther;
+        case INPluralRuleOneOther:
+        default:
+            return (isInteger && integer == 1) ? INPluralCategoryOne : INPluralCategoryOther;
+    }
+}
+
+// Returns the plural category for a keyword of a pattern or -1 if it's no keyword.
+static NSInteger INPluralCategoryForKeyword(NSString *keyword) {
+    static NSDictionary *categoriesByKeyword = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        categoriesByKeyword = @{@"zero": @(INPluralCategoryZero), @"one": @(INPluralCategoryOne), @"two": @(INPluralCategoryTwo),
+                                @"few": @(INPluralCategoryFew), @"many": @(INPluralCategoryMany), @"other": @(INPluralCategoryOther)};
+    });
+    NSNumber *category = categoriesByKeyword[keyword];
+    return category != nil ? [category integerValue] : -1;
+}
+
+
+#pragma mark - Nodes
+
+// Returns the string to insert for an argument.
+static NSString *INMessageFormatArgumentString(id argument) {
+    if ([argument isKindOfClass:[NSString class]]) {
+        return argument;
+    }
+    if ([argument isKindOfClass:[NSNumber class]]) {
+        return [argument stringValue];
+    }
+    return [argument description];
+}
+
+// Returns the argument at an index or nil if there are not enough arguments.
+static id INMessageFormatArgument(NSArray *arguments, NSUInteger index) {
+    return index < arguments.count ? arguments[index] : nil;
+}
+
+
+// The base class of the compiled parts of a message.
+@interface INMessageFormatNode : NSObject
+
+// Appends this node, the plural number is the number to insert for a '#' or nil if not inside of a plural argument.
+- (void)appendToString:(NSMutableString *)string arguments:(NSArray *)arguments language:(NSString *)language pluralNumber:(NSNumber *)pluralNumber;
+
+@end
+
+@implementation INMessageFormatNode
+
+- (void)appendToString:(NSMutableString *)string arguments:(NSArray *)arguments language:(NSString *)language pluralNumber:(NSNumber *)pluralNumber {
+    // to implement by subclasses
+}
+
+@end
+
+
+static void INMessageFormatAppendNodes(NSArray *nodes, NSMutableString *string, NSArray *arguments, NSString *language, NSNumber *pluralNumber) {
+    for (INMessageFormatNode *node in nodes) {
+        [node appendToString:string arguments:arguments language:language pluralNumber:pluralNumber];
+    }
+}
+
+
+// Literal text.
+@interface INMessageFormatTextNode : INMessageFormatNode
+
+@property (nonatomic, copy) NSString *text;
+
+@end
+
+@implementation INMessageFormatTextNode
+
+- (void)appendToString:(NSMutableString *)string arguments:(NSArray *)arguments language:(NSString *)language pluralNumber:(NSNumber *)pluralNumber {
+    [string appendString:self.text];
+}
+
+@end
+
+
+// A simple argument like '{0}'.
+@interface INMessageFormatArgumentNode : INMessageFormatNode
+
+@property (nonatomic, assign) NSUInteger index;
+
+@end
+
+@implementation INMessageFormatArgumentNode
+
+- (void)appendToString:(NSMutableString *)string arguments:(NSArray *)arguments language:(NSString *)language pluralNumber:(NSNumber *)pluralNumber {
+    id argument = INMessageFormatArgument(arguments, self.index);
+    if (argument == nil) {
+        [string appendFormat:@"{%lu}", (unsigned long)self.index];
+    } else {
+        [string appendString:INMessageFormatArgumentString(argument)];
+    }
+}
+
+@end
+
+
+// The '#' inside of a plural argument.
+@interface INMessageFormatPoundNode : INMessageFormatNode
+@end
+
+@implementation INMessageFormatPoundNode
+
+- (void)appendToString:(NSMutableString *)string arguments:(NSArray *)arguments language:(NSString *)language pluralNumber:(NSNumber *)pluralNumber {
+    [string appendString:(pluralNumber != nil ? [pluralNumber stringValue] : @"#")];
+}
+
+@end
+
+
+// A plural argument like '{0, plural, one {...} other {...}}'.
+@interface INMessageFormatPluralNode : INMessageFormatNode
+
+@property (nonatomic, assign) NSUInteger index;
+@property (nonatomic, assign) double offset;
+@property (nonatomic, strong) NSDictionary *exactMessages; // NSNumber -> NSArray of nodes
+@property (nonatomic, strong) NSArray *categoryMessages; // indexed by INPluralCategory, NSNull for missing categories
+
+@end
+
+@implementation INMessageFormatPluralNode
+
+- (void)appendToString:(NSMutableString *)string arguments:(NSArray *)arguments language:(NSString *)language pluralNumber:(NSNumber *)pluralNumber {
+    id argument = INMessageFormatArgument(arguments, self.index);
+    double number = [argument respondsToSelector:@selector(doubleValue)] ? [argument doubleValue] : 0.0;
+    
+    // exact matches use the number without offset, the categories and '#' the number with offset
+    NSArray *message = self.exactMessages[@(number)];
+    double offsetNumber = number - self.offset;
+    if (message == nil) {
+        message = self.categoryMessages[INPluralCategoryForNumber(language, offsetNumber)];
+        if ((id)message == [NSNull null]) {
+            message = self.categoryMessages[INPluralCategoryOther];
+        }
+    }
+    INMessageFormatAppendNodes(message, string, arguments, language, @(offsetNumber));
+}
+
+@end
+
+
+// A select argument like '{0, select, male {...} other {...}}'.
+@interface INMessageFormatSelectNode : INMessageFormatNode
+
+@property (nonatomic, assign) NSUInteger index;
+@property (nonatomic, strong) NSDictionary *messages; // NSString -> NSArray of nodes
+
+@end
+
+@implementation INMessageFormatSelectNode
+
+- (void)appendToString:(NSMutableString *)string arguments:(NSArray *)arguments language:(NSString *)language pluralNumber:(NSNumber *)pluralNumber {
+    id argument = INMessageFormatArgument(arguments, self.index);
+    NSArray *message = (argument != nil) ? self.messages[INMessageFormatArgumentString(argument)] : nil;
+    if (message == nil) {
+        message = self.messages[@"other"];
+    }
+    INMessageFormatAppendNodes(message, string, arguments, language, pluralNumber);
+}
+
+@end
+
+
+#pragma mark - Parser
+
+typedef struct {
+    const unichar *characters;
+    NSUInteger length;
+    NSUInteger position;
+} INMessageFormatParser;
+
+
+static NSArray *INMessageFormatParseMessage(INMessageFormatParser *parser, BOOL inPlural, BOOL nested);
+
+
+static void INMessageFormatSkipWhitespace(INMessageFormatParser *parser) {
+    NSCharacterSet *whitespaces = [NSCharacterSet whitespaceAndNewlineCharacterSet];
+    while (parser->position < parser->length && [whitespaces characterIsMember:parser->characters[parser->position]]) {
+        parser->position++;
+    }
+}
+
+static BOOL INMessageFormatConsume(INMessageFormatParser *parser, unichar character) {
+    if (parser->position < parser->length && parser->characters[parser->position] == character) {
+        parser->position++;
+        return YES;
+    }
+    return NO;
+}
+
+// Parses a word of letters, digits and underscores, returns nil if there is none.
+static NSString *INMessageFormatParseWord(INMessageFormatParser *parser) {
+    NSCharacterSet *wordCharacters = [NSCharacterSet alphanumericCharacterSet];
+    NSUInteger start = parser->position;
+    while (parser->position < parser->length) {
+        unichar character = parser->characters[parser->position];
+        if (![wordCharacters characterIsMember:character] && character != '_') {
+            break;
+        }
+        parser->position++;
+    }
+    if (parser->position == start) {
+        return nil;
+    }
+    return [NSString stringWithCharacters:parser->characters + start length:parser->position - start];
+}
+
+// Parses a decimal number, returns nil if there is none.
+static NSNumber *INMessageFormatParseNumber(INMessageFormatParser *parser) {
+    NSUInteger start = parser->position;
+    if (parser->position < parser->length && parser->characters[parser->position] == '-') {
+        parser->position++;
+    }
+    NSUInteger digitsStart = parser->position;
+    while (parser->position < parser->length) {
+        unichar character = parser->characters[parser->position];
+        if ((character < '0' || character > '9') && character != '.') {
+            break;
+        }
+        parser->position++;
+    }
+    if (parser->position == digitsStart) {
+        return nil;
+    }
+    NSString *number = [NSString stringWithCharacters:parser->characters + start length:parser->position - start];
+    return @([number doubleValue]);
+}
+
+// Parses the '{message}' of a plural or select option.
+static NSArray *INMessageFormatParseOptionMessage(INMessageFormatParser *parser, BOOL inPlural) {
+    INMessageFormatSkipWhitespace(parser);
+    if (!INMessageFormatConsume(parser, '{')) {
+        return nil;
+    }
+    NSArray *message = INMessageFormatParseMessage(parser, inPlural, YES);
+    if (message == nil || !INMessageFormatConsume(parser, '}')) {
+        return nil;
+    }
+    return message;
+}
+
+static INMessageFormatNode *INMessageFormatParsePlural(INMessageFormatParser *parser, NSUInteger index) {
+    INMessageFormatPluralNode *node = [[INMessageFormatPluralNode alloc] init];
+    node.index = index;
+    NSMutableDictionary *exactMessages = [NSMutableDictionary dictionary];
+    NSMutableArray *categoryMessages = [NSMutableArray array];
+    for (NSInteger category = INPluralCategoryZero; category <= INPluralCategoryOther; category++) {
+        [categoryMessages addObject:[NSNull null]];
+    }
+    
+    INMessageFormatSkipWhitespace(parser);
+    NSString *offsetKeyword = @"offset:";
+    if (parser->length - parser->position > offsetKeyword.length
+        && [[NSString stringWithCharacters:parser->characters + parser->position length:offsetKeyword.length] isEqualToString:offsetKeyword]) {
+        parser->position += offsetKeyword.length;
+        INMessageFormatSkipWhitespace(parser);
+        NSNumber *offset = INMessageFormatParseNumber(parser);
+        if (offset == nil) {
+            return nil;
+        }
+        node.offset = [offset doubleValue];
+    }
+    
+    while (YES) {
+        INMessageFormatSkipWhitespace(parser);
+        if (INMessageFormatConsume(parser, '}')) {
+            break;
+        }
+        if (INMessageFormatConsume(parser, '=')) {
+            NSNumber *number = INMessageFormatParseNumber(parser);
+            NSArray *message = INMessageFormatParseOptionMessage(parser, YES);
+            if (number == nil || message == nil) {
+                return nil;
+            }
+            exactMessages[number] = message;
+        } else {
+            NSInteger category = INPluralCategoryForKeyword(INMessageFormatParseWord(parser));
+            NSArray *message = INMessageFormatParseOptionMessage(parser, YES);
+            if (category < 0 || message == nil) {
+                return nil;
+            }
+            categoryMessages[category] = message;
+        }
+    }
+    
+    if (categoryMessages[INPluralCategoryOther] == [NSNull null]) {
+        // the other category is mandatory
+        return nil;
+    }
+    node.exactMessages = exactMessages;
+    node.categoryMessages = categoryMessages;
+    return node;
+}
+
+static INMessageFormatNode *INMessageFormatParseSelect(INMessageFormatParser *parser, NSUInteger index, BOOL inPlural) {
+    NSMutableDictionary *messages = [NSMutableDictionary dictionary];
+    while (YES) {
+        INMessageFormatSkipWhitespace(parser);
+        if (INMessageFormatConsume(parser, '}')) {
+            break;
+        }
+        NSString *keyword = INMessageFormatParseWord(parser);
+        NSArray *message = INMessageFormatParseOptionMessage(parser, inPlural);
+        if (keyword == nil || message == nil) {
+            return nil;
+        }
+        messages[keyword] = message;
+    }
+    
+    if (messages[@"other"] == nil) {
+        // the other keyword is mandatory
+        return nil;
+    }
+    INMessageFormatSelectNode *node = [[INMessageFormatSelectNode alloc] init];
+    node.index = index;
+    node.messages = messages;
+    return node;
+}
+
+// Parses an argument beginning after the opening brace and ending after the closing one.
+static INMessageFormatNode *INMessageFormatParseArgument(INMessageFormatParser *parser, BOOL inPlural) {
+    INMessageFormatSkipWhitespace(parser);
+    NSNumber *index = INMessageFormatParseNumber(parser);
+    if (index == nil || [index doubleValue] < 0) {
+        return nil;
+    }
+    INMessageFormatSkipWhitespace(parser);
+    
+    if (!INMessageFormatConsume(parser, ',')) {
+        if (!INMessageFormatConsume(parser, '}')) {
+            return nil;
+        }
+        INMessageFormatArgumentNode *node = [[INMessageFormatArgumentNode alloc] init];
+        node.index = [index unsignedIntegerValue];
+        return node;
+    }
+    
+    INMessageFormatSkipWhitespace(parser);
+    NSString *type = INMessageFormatParseWord(parser);
+    INMessageFormatSkipWhitespace(parser);
+    if ([type isEqualToString:@"plural"] || [type isEqualToString:@"select"]) {
+        if (!INMessageFormatConsume(parser, ',')) {
+            return nil;
+        }
+        if ([type isEqualToString:@"plural"]) {
+            return INMessageFormatParsePlural(parser, [index unsignedIntegerValue]);
+        }
+        return INMessageFormatParseSelect(parser, [index unsignedIntegerValue], inPlural);
+    }
+    
+    // any other type like 'number' is formatted as a simple argument, its style will be ignored
+    while (parser->position < parser->length && parser->characters[parser->position] != '}') {
+        parser->position++;
+    }
+    if (!INMessageFormatConsume(parser, '}')) {
+        return nil;
+    }
+    INMessageFormatArgumentNode *node = [[INMessageFormatArgumentNode alloc] init];
+    node.index = [index unsignedIntegerValue];
+    return node;
+}
+
+// Parses a message until the end of the pattern or until the closing brace of a nested message, which will not be consumed.
+static NSArray *INMessageFormatParseMessage(INMessageFormatParser *parser, BOOL inPlural, BOOL nested) {
+    NSMutableArray *nodes = [NSMutableArray array];
+    NSMutableString *text = [NSMutableString string];
+    
+    void (^flushText)(void) = ^{
+        if (text.length > 0) {
+            INMessageFormatTextNode *node = [[INMessageFormatTextNode alloc] init];
+            node.text = text;
+            [nodes addObject:node];
+            [text setString:@""];
+        }
+    };
+    
+    while (parser->position < parser->length) {
+        unichar character = parser->characters[parser->position];
+        
+        if (character == '\'') {
+            unichar next = (parser->position + 1 < parser->length) ? parser->characters[parser->position + 1] : 0;
+            if (next == '\'') {
+                // a doubled apostrophe is a single one
+                [text appendString:@"'"];
+                parser->position += 2;
+            } else if (next == '{' || next == '}' || (inPlural && next == '#')) {
+                // quoted literal text up to the next single apostrophe
+                parser->position++;
+                while (parser->position < parser->length) {
+                    unichar quoted = parser->characters[parser->position];
+                    if (quoted == '\'') {
+                        if (parser->position + 1 < parser->length && parser->characters[parser->position + 1] == '\'') {
+                            [text appendString:@"'"];
+                            parser->position += 2;
+                            continue;
+                        }
+                        parser->position++;
+                        break;
+                    }
+                    [text appendFormat:@"%C", quoted];
+                    parser->position++;
+                }
+            } else {
+                [text appendString:@"'"];
+                parser->position++;
+            }
+        } else if (character == '{') {
+            flushText();
+            parser->position++;
+            INMessageFormatNode *node = INMessageFormatParseArgument(parser, inPlural);
+            if (node == nil) {
+                return nil;
+            }
+            [nodes addObject:node];
+        } else if (character == '}') {
+            if (!nested) {
+                // unbalanced closing brace
+                return nil;
+            }
+            break;
+        } else if (character == '#' && inPlural) {
+            flushText();
+            [nodes addObject:[[INMessageFormatPoundNode alloc] init]];
+            parser->position++;
+        } else {
+            [text appendFormat:@"%C", character];
+            parser->position++;
+        }
+    }
+    
+    if (nested && parser->position >= parser->length) {
+        // missing closing brace
+        return nil;
+    }
+    flushText();
+    return nodes;
+}
+
+
+#pragma mark - Message format
+
+@interface INMessageFormat ()
+
+@property (nonatomic, copy, readwrite) NSString *pattern;
+@property (nonatomic, strong) NSArray *nodes;
+
+@end
+
+
+@implementation INMessageFormat
+
++ (instancetype)messageFormatWithPattern:(NSString *)pattern {
+    if (pattern == nil) {
+        return nil;
+    }
+    
+    NSUInteger length = pattern.length;
+    unichar *characters = malloc(MAX(length, 1) * sizeof(unichar));
+    if (characters == NULL) {
+        return nil;
+    }
+    [pattern getCharacters:characters range:NSMakeRange(0, length)];
+    INMessageFormatParser parser = {characters, length, 0};
+    NSArray *nodes = INMessageFormatParseMessage(&parser, NO, NO);
+    free(characters);
+    if (nodes == nil) {
+        return nil;
+    }
+    
+    INMessageFormat *format = [[self alloc] init];
+    format.pattern = pattern;
+    format.nodes = nodes;
+    return format;
+}
+
+- (NSString *)stringWithArguments:(NSArray *)arguments language:(NSString *)language {
+    NSMutableString *string = [NSMutableString string];
+    [self appendToString:string arguments:arguments language:language];
+    return [string copy];
+}
+
+- (void)appendToString:(NSMutableString *)string arguments:(NSArray *)arguments language:(NSString *)language {
+    INMessageFormatAppendNodes(self.nodes, string, arguments, language, nil);
+}
+
+
+@end
@@ -24,4 +24,8 @@
 #import "NSManagedObject+INExtensions.h"
 #import "NSManagedObjectModel+INExtension.h"
 
+#import "INCoreDataChangeLog.h"
 #import "INCoreDataManager.h"
+#import "INCoreDataSaveScheduler.h"
+#import "INCoreDataStoreConfiguration.h"
+#import "INFetchOptions.h"
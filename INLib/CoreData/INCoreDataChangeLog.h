@@ -0,0 +1,109 @@
+// INCoreDataChangeLog.h
+//
+// Copyright (c) 2014 Sven Korset
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#import <Foundation/Foundation.h>
+
+
+/// The kind of change of an object recorded in a INCoreDataChangeLog.
+typedef NS_ENUM(NSInteger, INCoreDataChangeType) {
+    INCoreDataChangeTypeInsert = 0,
+    INCoreDataChangeTypeUpdate,
+    INCoreDataChangeTypeDelete,
+};
+
+
+/// One recorded change of an object.
+@interface INCoreDataChange : NSObject
+
+/// The token of the change, each change has a greater token than all prior ones.
+@property (nonatomic, assign, readonly) unsigned long long token;
+/// The kind of change.
+@property (nonatomic, assign, readonly) INCoreDataChangeType type;
+/// The name of the changed object's entity.
+@property (nonatomic, copy, readonly) NSString *entityName;
+/// The URI representation of the changed object's ID, use managedObjectIDForURIRepresentation: of the store coordinator to get the ID.
+@property (nonatomic, strong, readonly) NSURL *objectURI;
+
+@end
+
+
+/**
+ An append-only log of the objects inserted, updated and deleted in a store.
+ 
+ Each recorded change gets a token which is greater than the token of each prior change, starting with 1.
+ A sync only has to remember the token of the last change it has processed and can then ask for the changes since that token,
+ so the costs are proportional to the changes and not to the size of the store.
+ 
+ The log is kept in a compact text file, one line per change, and is safe to use from any thread.
+ Normally the log is created and fed by INCoreDataManager, see its changeTrackingEnabled property.
+ 
+ The log is not transactional with the store, the changes are appended after the store has saved them.
+ A crash between the save and the append or a failed append drops these changes from the log,
+ so a sync should still be able to recover with a full comparison of the store.
+ 
+    [manager.changeLog enumerateChangesSinceToken:lastSyncToken batchSize:100 usingBlock:^(NSArray *changes, BOOL *stop) {
+        [self uploadChanges:changes];
+        lastSyncToken = [[changes lastObject] token];
+    }];
+ */
+@interface INCoreDataChangeLog : NSObject
+
+/**
+ Initializes the log with a file to which the changes are appended.
+ 
+ An existing file will be continued, thus the tokens stay monotonic over multiple launches.
+ 
+ @param url The URL of the log file or nil to hold the log only in memory.
+ @return The initialized instance.
+ */
+- (instancetype)initWithUrl:(NSURL *)url;
+
+/// The URL of the log file, nil if the log is held in memory.
+@property (nonatomic, strong, readonly) NSURL *url;
+
+/// The token of the last recorded change or 0 if there is none.
+@property (nonatomic, assign, readonly) unsigned long long currentToken;
+
+/**
+ Appends the changes of a save to the log.
+ 
+ @param insertedObjectIDs The NSManagedObjectID objects of the inserted objects. May be nil.
+ @param updatedObjectIDs The NSManagedObjectID objects of the updated objects. May be nil.
+ @param deletedObjectIDs The NSManagedObjectID objects of the deleted objects. May be nil.
+ @return The token of the last appended change, which is the current token afterwards,
+ or 0 if the changes couldn't be written, then the log is left unchanged.
+ */
+- (unsigned long long)appendInsertedObjectIDs:(NSArray *)insertedObjectIDs updatedObjectIDs:(NSArray *)updatedObjectIDs deletedObjectIDs:(NSArray *)deletedObjectIDs;
+
+/**
+ Enumerates the changes recorded after a token in batches.
+ 
+ Only the changes recorded until this method is called will be enumerated.
+ 
+ @param token The token of the last processed change or 0 to get all changes.
+ @param batchSize The maximum number of changes passed at once to the block.
+ @param block The block which will be called with an array of INCoreDataChange objects in the order of their tokens. Set stop to true to end the enumeration.
+ */
+- (void)enumerateChangesSinceToken:(unsigned long long)token batchSize:(NSUInteger)batchSize usingBlock:(void (^)(NSArray *changes, BOOL *stop))block;
+
+@end
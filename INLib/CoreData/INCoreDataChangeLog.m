@@ -0,0 +1,260 @@
+// INCoreDataChangeLog.m
+//
+// Copyright (c) 2014 Sven Korset
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#import "INCoreDataChangeLog.h"
+
+#import <CoreData/CoreData.h>
+#import <fcntl.h>
+#import <unistd.h>
+
+
+// Every this many changes the offset of a change is indexed, so a token can be found without parsing the log from its beginning.
+static unsigned long long const INChangeLogIndexInterval = 256;
+
+// The characters used in the log for the change types.
+static char const INChangeLogTypeCharacters[] = { 'I', 'U', 'D' };
+
+
+@interface INCoreDataChange ()
+
+@property (nonatomic, assign, readwrite) unsigned long long token;
+@property (nonatomic, assign, readwrite) INCoreDataChangeType type;
+@property (nonatomic, copy, readwrite) NSString *entityName;
+@property (nonatomic, strong, readwrite) NSURL *objectURI;
+
+@end
+
+
+@implementation INCoreDataChange
+@end
+
+
+@interface INCoreDataChangeLog ()
+
+@property (nonatomic, strong, readwrite) NSURL *url;
+@property (nonatomic, assign, readwrite) unsigned long long currentToken;
+
+@property (nonatomic, strong) dispatch_queue_t queue;
+@property (nonatomic, assign) int fileDescriptor;
+@property (nonatomic, strong) NSMutableData *memoryData; // the log if held in memory
+@property (nonatomic, assign) unsigned long long length; // the log's length in bytes
+@property (nonatomic, strong) NSMutableData *index; // the offsets of the tokens 1, 1 + interval, 1 + 2 * interval, etc. as unsigned long long
+
+@end
+
+
+// Parses one line of the log, a line has the format '<token> <type> <entity name> <object URI>'.
+// Returns a pointer behind the line's end or NULL if the line is incomplete.
+static const char *INChangeLogParseLine(const char *line, const char *end, unsigned long long *token, const char **fields) {
+    const char *lineEnd = memchr(line, '\n', end - line);
+    if (lineEnd == NULL) {
+        return NULL;
+    }
+    *token = strtoull(line, NULL, 10);
+    if (fields != NULL) {
+        const char *field = line;
+        for (NSUInteger i = 0; i < 3; ++i) {
+            field = memchr(field, ' ', lineEnd - field);
+            if (field == NULL) {
+                return NULL;
+            }
+            fields[i] = ++field;
+        }
+        fields[3] = lineEnd;
+    }
+    return lineEnd + 1;
+}
+
+
+@implementation INCoreDataChangeLog
+
+- (instancetype)initWithUrl:(NSURL *)url {
+    self = [super init];
+    if (self == nil) return self;
+    
+    _url = url;
+    _queue = dispatch_queue_create("INCoreDataChangeLog", DISPATCH_QUEUE_SERIAL);
+    _index = [NSMutableData data];
+    _fileDescriptor = -1;
+    
+    if (url == nil) {
+        _memoryData = [NSMutableData data];
+        return self;
+    }
+    
+    // continue an existing log by finding its last token and indexing it
+    NSData *data = [NSData dataWithContentsOfURL:url options:NSDataReadingMappedIfSafe error:NULL];
+    const char *bytes = data.bytes;
+    const char *end = bytes + data.length;
+    const char *line = bytes;
+    unsigned long long token = 0;
+    while (line != NULL && line < end) {
+        const char *nextLine = INChangeLogParseLine(line, end, &token, NULL);
+        if (nextLine == NULL) {
+            // an incomplete line of an interrupted write
+            break;
+        }
+        [self indexToken:token atOffset:line - bytes];
+        _currentToken = token;
+        line = nextLine;
+    }
+    _length = (line != NULL) ? line - bytes : 0;
+    
+    _fileDescriptor = open(url.path.fileSystemRepresentation, O_WRONLY | O_CREAT, 0644);
+    if (_fileDescriptor >= 0) {
+        // drop an incomplete line
+        ftruncate(_fileDescriptor, (off_t)_length);
+        lseek(_fileDescriptor, 0, SEEK_END);
+    }
+    
+    return self;
+}
+
+- (void)dealloc {
+    if (_fileDescriptor >= 0) {
+        close(_fileDescriptor);
+    }
+}
+
+- (void)indexToken:(unsigned long long)token atOffset:(unsigned long long)offset {
+    if ((token - 1) % INChangeLogIndexInterval == 0) {
+        [self.index appendBytes:&offset length:sizeof(offset)];
+    }
+}
+
+
+#pragma mark - Appending
+
+- (unsigned long long)appendInsertedObjectIDs:(NSArray *)insertedObjectIDs updatedObjectIDs:(NSArray *)updatedObjectIDs deletedObjectIDs:(NSArray *)deletedObjectIDs {
+    // in the order of the change types
+    NSArray *objectIDsByType = @[(insertedObjectIDs != nil) ? insertedObjectIDs : @[],
+                                 (updatedObjectIDs != nil) ? updatedObjectIDs : @[],
+                                 (deletedObjectIDs != nil) ? deletedObjectIDs : @[]];
+    __block unsigned long long lastToken = 0;
+    dispatch_sync(self.queue, ^{
+        NSUInteger indexLength = self.index.length;
+        NSMutableData *lines = [NSMutableData data];
+        unsigned long long token = self.currentToken;
+        for (NSUInteger type = 0; type < objectIDsByType.count; ++type) {
+            for (NSManagedObjectID *objectID in objectIDsByType[type]) {
+                ++token;
+                [self indexToken:token atOffset:self.length + lines.length];
+                NSString *line = [NSString stringWithFormat:@"%llu %c %@ %@\n", token, INChangeLogTypeCharacters[type], objectID.entity.name, objectID.URIRepresentation.absoluteString];
+                [lines appendData:[line dataUsingEncoding:NSUTF8StringEncoding]];
+            }
+        }
+        
+        BOOL written = YES;
+        if (self.memoryData != nil) {
+            [self.memoryData appendData:lines];
+        } else if (self.fileDescriptor >= 0) {
+            const char *bytes = lines.bytes;
+            for (NSUInteger offset = 0; offset < lines.length && written;) {
+                ssize_t bytesWritten = write(self.fileDescriptor, bytes + offset, lines.length - offset);
+                if (bytesWritten >= 0) {
+                    offset += bytesWritten;
+                } else {
+                    written = (errno == EINTR);
+                }
+            }
+            if (!written) {
+                // drop what has been written of the lines, so the file, the index and the tokens stay in sync
+                ftruncate(self.fileDescriptor, (off_t)self.length);
+                lseek(self.fileDescriptor, 0, SEEK_END);
+            }
+        } else {
+            written = NO;
+        }
+        if (!written) {
+            [self.index setLength:indexLength];
+            return;
+        }
+        self.length += lines.length;
+        self.currentToken = token;
+        lastToken = token;
+    });
+    return lastToken;
+}
+
+
+#pragma mark - Reading
+
+- (void)enumerateChangesSinceToken:(unsigned long long)token batchSize:(NSUInteger)batchSize usingBlock:(void (^)(NSArray *changes, BOOL *stop))block {
+    // take a snapshot of the log's current end and start at the nearest indexed token
+    __block NSData *data = nil;
+    __block unsigned long long startOffset = 0;
+    __block unsigned long long endOffset = 0;
+    dispatch_sync(self.queue, ^{
+        NSUInteger indexCount = self.index.length / sizeof(unsigned long long);
+        if (indexCount > 0) {
+            NSUInteger indexPosition = (NSUInteger)MIN(token / INChangeLogIndexInterval, indexCount - 1);
+            startOffset = ((const unsigned long long *)self.index.bytes)[indexPosition];
+        }
+        endOffset = self.length;
+        if (self.memoryData != nil) {
+            data = [self.memoryData subdataWithRange:NSMakeRange(0, (NSUInteger)endOffset)];
+        } else {
+            data = [NSData dataWithContentsOfURL:self.url options:NSDataReadingMappedIfSafe error:NULL];
+        }
+    });
+    if (data == nil || batchSize == 0) {
+        return;
+    }
+    
+    const char *bytes = data.bytes;
+    const char *end = bytes + MIN(endOffset, data.length);
+    const char *line = bytes + startOffset;
+    NSMutableArray *changes = [NSMutableArray arrayWithCapacity:batchSize];
+    BOOL stop = NO;
+    while (line < end && !stop) {
+        @autoreleasepool {
+            unsigned long long changeToken;
+            const char *fields[4];
+            const char *nextLine = INChangeLogParseLine(line, end, &changeToken, fields);
+            if (nextLine == NULL) {
+                break;
+            }
+            if (changeToken > token) {
+                INCoreDataChange *change = [[INCoreDataChange alloc] init];
+                change.token = changeToken;
+                const char *typeCharacter = memchr(INChangeLogTypeCharacters, fields[0][0], sizeof(INChangeLogTypeCharacters));
+                change.type = (typeCharacter != NULL) ? (INCoreDataChangeType)(typeCharacter - INChangeLogTypeCharacters) : INCoreDataChangeTypeUpdate;
+                change.entityName = [[NSString alloc] initWithBytes:fields[1] length:fields[2] - fields[1] - 1 encoding:NSUTF8StringEncoding];
+                NSString *uri = [[NSString alloc] initWithBytes:fields[2] length:fields[3] - fields[2] encoding:NSUTF8StringEncoding];
+                change.objectURI = [NSURL URLWithString:uri];
+                [changes addObject:change];
+                
+                if (changes.count == batchSize) {
+                    block([changes copy], &stop);
+                    [changes removeAllObjects];
+                }
+            }
+            line = nextLine;
+        }
+    }
+    if (changes.count > 0 && !stop) {
+        block([changes copy], &stop);
+    }
+}
+
+@end
@@ -24,6 +24,20 @@
 @class NSManagedObjectContext;
 @class NSManagedObjectModel;
 @class NSPersistentStoreCoordinator;
+@class INCoreDataStoreConfiguration;
+@class INCoreDataChangeLog;
+@class INCoreDataSaveScheduler;
+
+
+/// The type of store managed by INCoreDataManager.
+typedef NS_ENUM(NSInteger, INCoreDataStoreType) {
+    /// A SQLite store file at the given store location.
+    INCoreDataStoreTypeSQLite = 0,
+    /// A store which is only held in memory and is gone with the store coordinator.
+    INCoreDataStoreTypeInMemory,
+    /// A SQLite store file in its own temporary directory, which will be deleted with the manager.
+    INCoreDataStoreTypeTemporarySQLite,
+};
 
 
 /**
@@ -35,7 +49,8 @@
  It is mandatory that the version files follow a naming convention in which they have the same name as the model's version itself
  followed by an underscore and the version number without leading zeros.
  
- Only SQLite stores are supported and only one per model.
+ By default a SQLite store is used, only one per model.
+ For tests and transient caches an in-memory store or a temporary SQLite store can be used instead, see initWithName:version:storeType:storeLocation:.
  The store file will be named the same as the model and will resists in the given folder of the app indicated when calling the init method, i.e. 'Documents/MyModel.sqlite'.
  Beware of the other files corresponding to the store on iOS 7+, which have the extensions 'sqlite-shm' and 'sqlite.wal'.
  
@@ -45,6 +60,7 @@
  An outdated store can then be migrated either with a custom mapping model or via automatic.
  This works automatically, however if a custom mapping model is available it will be prefered.
  The migration even works over multiple versions, so it is possible to automatically migrate a store from version 1 to 3 when the migration from 1 to 2 and 2 to 3 work.
+ When possible the versions inbetween are skipped and the store is migrated from 1 to 3 directly.
  
  Check if a given store needs to be migrated and perform the migration if necessary before using the core data stack.
  By accessing the model, context or the store coordinator properties the corresponding instances will be created and returned.
@@ -94,16 +110,55 @@
  */
 - (instancetype)initWithName:(NSString *)name version:(NSInteger)modelVersion storeLocation:(NSString *)storeLocation;
 
+/**
+ Initializes the manager with a model name, a store type and a store location.
+ 
+ This method does the same as initWithName:version:storeType:storeLocation: with the model's default version.
+ 
+ @param name The model's name.
+ @param storeType The type of store to use.
+ @param storeLocation The directory of the SQLite store file(s). Ignored by in-memory and temporary stores.
+ @return The initialized instance.
+ @see initWithName:version:storeType:storeLocation:
+ */
+- (instancetype)initWithName:(NSString *)name storeType:(INCoreDataStoreType)storeType storeLocation:(NSString *)storeLocation;
+
+/**
+ Initializes the manager with a model name, a model version, a store type and a store location.
+ 
+ An in-memory store has no store URL, is never migrated and can't be duplicated or backed up.
+ Its store version is the version of the model it has been created with as soon as the store coordinator exists.
+ A temporary SQLite store behaves like a normal SQLite store, but gets its own directory in the app's temporary directory,
+ which will be deleted when the manager is deallocated.
+ 
+    INCoreDataManager *manager = [[INCoreDataManager alloc] initWithName:@"MyModel" version:0 storeType:INCoreDataStoreTypeInMemory storeLocation:nil];
+ 
+ @param name The model's name.
+ @param modelVersion The model's version number greater than 0. If 0 the model's default version will be used.
+ @param storeType The type of store to use.
+ @param storeLocation The directory of the SQLite store file(s). Ignored by in-memory and temporary stores.
+ @return The initialized instance.
+ */
+- (instancetype)initWithName:(NSString *)name version:(NSInteger)modelVersion storeType:(INCoreDataStoreType)storeType storeLocation:(NSString *)storeLocation;
+
 /// The model's name.
 @property (nonatomic, copy, readonly) NSString *modelName;
 
-/// The URL to the SQLite store.
+/// The URL to the SQLite store, nil for an in-memory store.
 @property (nonatomic, strong, readonly) NSURL *storeUrl;
 
+/// The type of the managed store.
+@property (nonatomic, assign, readonly) INCoreDataStoreType storeType;
+
+/// The tuning options of the SQLite store, which are used for the store coordinator, migrations and compatibility checks.
+/// Set this before accessing the core data stack or checking for a migration, default is nil to use the store's defaults.
+@property (nonatomic, copy) INCoreDataStoreConfiguration *storeConfiguration;
+
 
 /// @name Core Data Stack
 
 /// The currently managed object context.
+/// This context uses the legacy thread confinement and is independent of the context hierarchy of mainContext and writerContext.
 @property (nonatomic, strong, readonly) NSManagedObjectContext *managedObjectContext;
 /// The currently managed object model.
 @property (nonatomic, strong, readonly) NSManagedObjectModel *managedObjectModel;
@@ -111,6 +166,57 @@
 @property (nonatomic, strong, readonly) NSPersistentStoreCoordinator *persistentStoreCoordinator;
 
 
+/// @name Context hierarchy
+
+// The writer context is the only one of the hierarchy connected to the store coordinator and saves on its private queue.
+// The main context and all worker contexts are children of it, so imports on workers run in parallel with reads on the main queue.
+// Each time the writer has saved to the store, its changes are merged into the main context.
+
+/// The private queue context which writes to the store.
+@property (nonatomic, strong, readonly) NSManagedObjectContext *writerContext;
+/// The main queue context to be used by the UI, a child of the writer context.
+@property (nonatomic, strong, readonly) NSManagedObjectContext *mainContext;
+
+/// A scheduler which coalesces the changes of the main context into fewer saves to the store.
+/// It's created with the first access and starts observing the main context's changes from then on.
+/// The saves are written to the store together with those of saveContext:completion:, so the main queue never waits for the store.
+/// Changes not yet saved are discarded when the core data stack is closed, i.e. by deleteStore, so flush the scheduler before.
+@property (nonatomic, strong, readonly) INCoreDataSaveScheduler *saveScheduler;
+
+/**
+ Creates a new private queue context for background work, i.e. imports.
+ 
+ The context is a child of the writer context and has no undo manager.
+ Use performBlock: to work with it and saveContext:completion: to save it.
+ 
+ @return A new worker context or nil if the store can't be opened.
+ */
+- (NSManagedObjectContext *)newWorkerContext;
+
+/**
+ Saves a context of the hierarchy and then the writer context to the store.
+ 
+ The context will be saved on its own queue and each parent up to the writer context will be saved, too.
+ Saves which reach the writer context while it is busy are batched into one store transaction.
+ 
+ @param context The main context, a worker context or one of their children.
+ @param completion The block which will be called on the main queue after the changes have been written to the store or the save failed. May be nil.
+ */
+- (void)saveContext:(NSManagedObjectContext *)context completion:(void (^)(BOOL success, NSError *error))completion;
+
+
+/// @name Change tracking
+
+/// True to record the IDs of all inserted, updated and deleted objects in the change log whenever a context saves to the store, default is false.
+/// Saves of child contexts are recorded when their parent saves to the store.
+@property (nonatomic, assign) BOOL changeTrackingEnabled;
+
+/// The log of changes saved to the store while change tracking is enabled, nil if it's disabled.
+/// The log is kept in a file beside the store with the extension '.sqlite.changes', or in memory for an in-memory store.
+/// The file is not affected by deleteStore or duplicateStoreToUrl:, so the tokens stay monotonic even when the store is recreated.
+@property (nonatomic, strong, readonly) INCoreDataChangeLog *changeLog;
+
+
 /// @name Versions
 
 /**
@@ -158,10 +264,13 @@
  There has to be a SQLite store file on disc and with a lower version than the current model.
  To be sure that a migration is needed check prior with isMigrationNeeded.
  
- The migration will automatically apply from version to version in single version steps, i.e. from 1 to 2 and then from 2 to 3.
- If more steps are needed, i.e. from 1 to 3, the migration will automatically do the steps inbetween.
+ The migration is planned to need as few steps as possible, because each step rewrites the whole store.
+ If a mapping model from the store's version to a later version is available or can be inferred, i.e. from 1 to 3, the store is migrated directly.
+ Otherwise the migration will be applied in smaller steps, at most from version to version, i.e. from 1 to 2 and then from 2 to 3.
  
  If a custom migration mapping model is available it will be automatically used and prefered, otherwise an automatic mapping model will be used if possible.
+ An inferred mapping model will never skip a version step which has a custom mapping model.
+ Should a step fail its versions will be migrated one by one.
 
  The progress block will be called after each migration step with the version and the migration outcome.
  This is only for logging or another feedback possibility, but may also be nilif not needed, because there is no action needed.
@@ -171,6 +280,50 @@
 */
 - (BOOL)performMigration:(void (^)(NSInteger fromVersion, NSInteger toVersion, BOOL successfullyMigrated))progressBlock;
 
+/**
+ Performs a migration of a SQLite store and reports the number of processed bytes.
+ 
+ This method does the same as performMigration: except that the progress block also gets the total size of the store files
+ which have been read by the migration steps so far.
+ 
+ @param progressBlock The block which will be called after each migration step with the store version before migrating, the store version to which to migrate, the number of bytes processed so far and the migration outcome as a boolean flag. May be nil.
+ @return True if the migration could be performed without any errors, otherwise false.
+ @see performMigration:
+ */
+- (BOOL)performMigrationWithProgress:(void (^)(NSInteger fromVersion, NSInteger toVersion, unsigned long long bytesProcessed, BOOL successfullyMigrated))progressBlock;
+
+/**
+ Performs a migration of a SQLite store on a background queue.
+ 
+ The store is first duplicated into a staging directory beside it, like duplicateStoreToUrl: does, and only the copy is migrated.
+ When the migration succeeds the migrated copy replaces the store with one atomic move,
+ thus a crash or a cancellation during the migration will always leave the original store untouched.
+ The migration is planned the same way as with performMigration:.
+ 
+ The core data stack is closed when calling this method and must not be used until the completion block has been called,
+ so this method has to be called on the main thread.
+ The store is removed from the old store coordinator, so saves of contexts still connected to it fail instead of getting lost,
+ and persistentStoreCoordinator, writerContext and the contexts depending on them are nil while migrating.
+ Both blocks will be called on the main queue, the completion block even when no migration is needed.
+ Versions which can only be migrated one by one without a mapping model, because the planned step failed,
+ are migrated by Core Data's automatic migration, which neither reports progress nor can be cancelled until it has finished.
+ 
+ @param progressBlock The block which will be called repeatedly with the overall progress between 0 and 1. May be nil.
+ @param completion The block which will be called when the migration has finished, failed or was cancelled. May be nil.
+ @see cancelMigration
+ */
+- (void)performMigrationInBackground:(void (^)(float progress))progressBlock completion:(void (^)(BOOL successfullyMigrated, BOOL cancelled))completion;
+
+/**
+ Cancels a running background migration.
+ 
+ The store will remain in its prior version and the completion block of the migration will be called with the cancelled flag set.
+ */
+- (void)cancelMigration;
+
+/// True while a background migration is running.
+@property (atomic, assign, readonly, getter=isMigrating) BOOL migrating;
+
 
 /// @name Store manipulation
 
@@ -180,20 +333,36 @@
  Before calling this method any pending modifications should be saved.
  
  This is done by copying any files on disc directly to the new location instead of using `[NSPersistentStoreCoordinator migratePersistentStore:toURL:options:withType:error:]`, because we want to continue the old store and not the new migrated one.
- Each file at the current store's location with the same name of the model name will be copied, which will be not only the .sqlite file, but also the .sqlite-shm and .sqlite-wal files.
+ Only the .sqlite file and the files SQLite creates beside it, which are the .sqlite-shm, .sqlite-wal and .sqlite-journal files, will be copied.
+ The files are cloned on file systems which support it, so no extra disk space is needed until one of the stores is modified.
  
- @param url The URL which includes the new store's file name.
+ @param url The URL of the directory into which to copy the store's files.
  @return True if the store could be duplicated, false if an error occured.
+ @see backupStoreToUrl:
 */
 - (BOOL)duplicateStoreToUrl:(NSURL *)url;
 
 
+/**
+ Copies the store into a new SQLite file with SQLite's online backup.
+ 
+ Other than duplicateStoreToUrl: the core data stack will not be closed and may be used while the backup is made.
+ The backup is a consistent snapshot of the store, but changes not yet saved to the store won't be included.
+ An existing store at the backup's location will be overwritten, its -wal and -shm files are removed beforehand.
+ The store is copied in small steps for a few seconds, a write to the store restarts the copy, so what's left after that is copied in one step.
+ When the store stays locked by other connections the backup gives up and fails.
+ 
+ @param url The URL which includes the backup's file name.
+ @return True if the backup could be made, false if an error occured.
+ */
+- (BOOL)backupStoreToUrl:(NSURL *)url;
+
+
 /**
  Deletes the corresponding SQLite store file(s).
  
- Each file at the store's directory which begins with the model's name and followed by '.sqlite' will be deleted.
- This will not only delete the .sqlite file itself, but also the .sqlite-shm and .sqlite-wal files.
- Other files or in subdirectories will not be affected.
+ This will not only delete the .sqlite file itself, but also the .sqlite-shm, .sqlite-wal and .sqlite-journal files.
+ Other files will not be affected.
  
  @return False if an error occured while deleting the files, otherwise true.
 */
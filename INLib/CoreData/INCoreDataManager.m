@@ -23,8 +23,14 @@
 
 #import "INCoreDataManager.h"
 #import "INCoreData.h"
+#import "INCoreDataStoreConfiguration.h"
 
 #import <CoreData/CoreData.h>
+#import <copyfile.h>
+#import <fcntl.h>
+#import <objc/runtime.h>
+#import <sqlite3.h>
+#import <unistd.h>
 
 
 @interface INCoreDataManager ()
@@ -32,54 +38,286 @@
 @property (nonatomic, strong, readwrite) NSManagedObjectContext *managedObjectContext;
 @property (nonatomic, strong, readwrite) NSManagedObjectModel *managedObjectModel;
 @property (nonatomic, strong, readwrite) NSPersistentStoreCoordinator *persistentStoreCoordinator;
+@property (nonatomic, strong, readwrite) NSManagedObjectContext *writerContext;
+@property (nonatomic, strong, readwrite) NSManagedObjectContext *mainContext;
 
 @property (nonatomic, copy, readwrite) NSString *modelName;
 @property (nonatomic, strong, readwrite) NSURL *storeUrl;
+@property (nonatomic, assign, readwrite) INCoreDataStoreType storeType;
+@property (nonatomic, strong, readwrite) INCoreDataChangeLog *changeLog;
+@property (nonatomic, strong, readwrite) INCoreDataSaveScheduler *saveScheduler;
 @property (nonatomic, assign) NSInteger versionForNewModel; // default is 0 = model's default version
 
+// state of a running background migration
+@property (atomic, assign, readwrite, getter=isMigrating) BOOL migrating;
+@property (atomic, assign) BOOL migrationCancelled;
+@property (atomic, strong) NSMigrationManager *currentMigrationManager;
+@property (atomic, assign) NSUInteger migrationStepIndex;
+@property (atomic, assign) NSUInteger migrationStepCount;
+@property (atomic, copy) void (^migrationProgressBlock)(float progress);
+
+@end
+
+
+/// One step of a migration plan which migrates the store with a single mapping model over one or more versions.
+@interface INCoreDataMigrationStep : NSObject
+
+@property (nonatomic, assign) NSInteger sourceVersion;
+@property (nonatomic, assign) NSInteger destinationVersion;
+@property (nonatomic, strong) NSMappingModel *mappingModel;
+
 @end
 
 
+@implementation INCoreDataMigrationStep
+@end
+
+
+// The suffixes of the files SQLite may create beside the store file.
+static NSString *const INStoreFileSuffixes[] = { @"", @"-wal", @"-shm", @"-journal" };
+
+static NSArray *INStoreFileUrls(NSURL *storeUrl) {
+    NSMutableArray *urls = [NSMutableArray array];
+    for (NSUInteger i = 0; i < sizeof(INStoreFileSuffixes) / sizeof(INStoreFileSuffixes[0]); ++i) {
+        NSString *path = [storeUrl.path stringByAppendingString:INStoreFileSuffixes[i]];
+        [urls addObject:[NSURL fileURLWithPath:path isDirectory:NO]];
+    }
+    return urls;
+}
+
+// The number of pages copied at once by the online backup, the store is only locked while copying them.
+static int const INStoreBackupPagesPerStep = 256;
+// The milliseconds to wait before continuing the online backup when the store is locked.
+static int const INStoreBackupRetryDelay = 10;
+// The number of times the online backup waits for a locked store before giving up.
+static int const INStoreBackupMaximumRetries = 500;
+// The seconds the online backup copies in steps, because each write to the store restarts it, the rest is copied at once.
+static CFTimeInterval const INStoreBackupStepwiseDuration = 5.0;
+
+static BOOL INCopyFile(NSString *sourcePath, NSString *destinationPath) {
+    const char *source = sourcePath.fileSystemRepresentation;
+    const char *destination = destinationPath.fileSystemRepresentation;
+    if (access(destination, F_OK) == 0) {
+        // never overwrite an existing file, same as NSFileManager
+        return NO;
+    }
+    
+#ifdef COPYFILE_CLONE
+    // clones the file on file systems which support it, so no data is copied and no extra disk space is needed
+    if (copyfile(source, destination, NULL, COPYFILE_CLONE) == 0) {
+        return YES;
+    }
+#else
+    if (copyfile(source, destination, NULL, COPYFILE_DATA) == 0) {
+        return YES;
+    }
+#endif
+    
+    // copyfile failed, so stream the data
+    int sourceFile = open(source, O_RDONLY);
+    if (sourceFile < 0) {
+        return NO;
+    }
+    int destinationFile = open(destination, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (destinationFile < 0) {
+        close(sourceFile);
+        return NO;
+    }
+    size_t const bufferSize = 1024 * 1024;
+    char *buffer = malloc(bufferSize);
+    BOOL success = (buffer != NULL);
+    while (success) {
+        ssize_t bytesRead = read(sourceFile, buffer, bufferSize);
+        if (bytesRead == 0) {
+            break;
+        } else if (bytesRead < 0) {
+            success = (errno == EINTR);
+            continue;
+        }
+        for (ssize_t offset = 0; offset < bytesRead && success;) {
+            ssize_t bytesWritten = write(destinationFile, buffer + offset, bytesRead - offset);
+            if (bytesWritten >= 0) {
+                offset += bytesWritten;
+            } else {
+                success = (errno == EINTR);
+            }
+        }
+    }
+    free(buffer);
+    close(sourceFile);
+    if (close(destinationFile) != 0 || !success) {
+        unlink(destination);
+        return NO;
+    }
+    return YES;
+}
+
+static unsigned long long INStoreFileSize(NSURL *storeUrl) {
+    unsigned long long size = 0;
+    for (NSURL *url in INStoreFileUrls(storeUrl)) {
+        size += [[[NSFileManager defaultManager] attributesOfItemAtPath:url.path error:NULL] fileSize];
+    }
+    return size;
+}
+
+
+// KVO context for observing the migration progress of the current migration manager.
+static void *INCoreDataManagerMigrationProgressContext = &INCoreDataManagerMigrationProgressContext;
+
+// The completion blocks of saves waiting for the next batched save of a writer context, only used on the writer's queue.
+static const char *pendingSaveCompletionsKey = "INCoreDataManager_pendingSaveCompletions";
+
+
 @implementation INCoreDataManager
 
 
 #pragma mark - Instance creation
 
 - (instancetype)initWithName:(NSString *)name storeLocation:(NSString *)storeLocation {
-    self = [super init];
-    if (self == nil) return self;
-    
-    self.modelName = name;
-
-    // get store URL
-    NSString *storeFile = [NSString stringWithFormat:@"%@.sqlite", self.modelName];
-    NSString *storePath = [storeLocation stringByAppendingPathComponent:storeFile];
-    self.storeUrl = [NSURL fileURLWithPath:storePath isDirectory:NO];
-    self.versionForNewModel = 0;
-    
-    return self;
+    return [self initWithName:name version:0 storeType:INCoreDataStoreTypeSQLite storeLocation:storeLocation];
 }
 
 - (instancetype)initWithName:(NSString *)name version:(NSInteger)modelVersion storeLocation:(NSString *)storeLocation {
+    return [self initWithName:name version:modelVersion storeType:INCoreDataStoreTypeSQLite storeLocation:storeLocation];
+}
+
+- (instancetype)initWithName:(NSString *)name storeType:(INCoreDataStoreType)storeType storeLocation:(NSString *)storeLocation {
+    return [self initWithName:name version:0 storeType:storeType storeLocation:storeLocation];
+}
+
+- (instancetype)initWithName:(NSString *)name version:(NSInteger)modelVersion storeType:(INCoreDataStoreType)storeType storeLocation:(NSString *)storeLocation {
     self = [super init];
     if (self == nil) return self;
     
     self.modelName = name;
+    self.storeType = storeType;
     
-    // get store URL
-    NSString *storeFile = [NSString stringWithFormat:@"%@.sqlite", self.modelName];
-    NSString *storePath = [storeLocation stringByAppendingPathComponent:storeFile];
-    self.storeUrl = [NSURL fileURLWithPath:storePath isDirectory:NO];
+    // get store URL, an in-memory store has none and a temporary store gets its own directory
+    if (storeType == INCoreDataStoreTypeTemporarySQLite) {
+        NSString *directoryName = [NSString stringWithFormat:@"%@-%@", name, [[NSUUID UUID] UUIDString]];
+        storeLocation = [NSTemporaryDirectory() stringByAppendingPathComponent:directoryName];
+        [[NSFileManager defaultManager] createDirectoryAtPath:storeLocation withIntermediateDirectories:YES attributes:nil error:NULL];
+    }
+    if (storeType != INCoreDataStoreTypeInMemory) {
+        NSString *storeFile = [NSString stringWithFormat:@"%@.sqlite", self.modelName];
+        NSString *storePath = [storeLocation stringByAppendingPathComponent:storeFile];
+        self.storeUrl = [NSURL fileURLWithPath:storePath isDirectory:NO];
+    }
     self.versionForNewModel = modelVersion;
     
     return self;
 }
 
+- (void)dealloc {
+    [[NSNotificationCenter defaultCenter] removeObserver:self];
+    
+    if (self.storeType == INCoreDataStoreTypeTemporarySQLite) {
+        // A temporary store lives only as long as its manager.
+        // Close its files before removing them, contexts of the app may still keep the coordinator alive.
+        NSPersistentStoreCoordinator *persistentStoreCoordinator = _persistentStoreCoordinator;
+        _managedObjectContext = nil;
+        _saveScheduler = nil;
+        _mainContext = nil;
+        _writerContext = nil;
+        _persistentStoreCoordinator = nil;
+        _changeLog = nil;
+        for (NSPersistentStore *store in persistentStoreCoordinator.persistentStores) {
+            [persistentStoreCoordinator removePersistentStore:store error:NULL];
+        }
+        persistentStoreCoordinator = nil;
+        [[NSFileManager defaultManager] removeItemAtURL:[self.storeUrl URLByDeletingLastPathComponent] error:NULL];
+    }
+}
+
+
+#pragma mark - Change tracking
+
+- (void)setChangeTrackingEnabled:(BOOL)changeTrackingEnabled {
+    // within the same lock as the creation of the writer context, which observes depending on this flag
+    @synchronized (self) {
+        if (_changeTrackingEnabled == changeTrackingEnabled) {
+            return;
+        }
+        _changeTrackingEnabled = changeTrackingEnabled;
+        
+        if (changeTrackingEnabled) {
+            // All contexts are observed, because any of them may be connected to the store coordinator, i.e. those of bulk imports.
+            // This includes the writer context, whose own observation would merge its saves twice.
+            if (_writerContext != nil) {
+                [[NSNotificationCenter defaultCenter] removeObserver:self name:NSManagedObjectContextDidSaveNotification object:_writerContext];
+            }
+            [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(contextDidSave:) name:NSManagedObjectContextDidSaveNotification object:nil];
+        } else {
+            [[NSNotificationCenter defaultCenter] removeObserver:self name:NSManagedObjectContextDidSaveNotification object:nil];
+            if (_writerContext != nil) {
+                [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(writerContextDidSave:) name:NSManagedObjectContextDidSaveNotification object:_writerContext];
+            }
+        }
+    }
+}
+
+- (INCoreDataChangeLog *)changeLog {
+    // created within a lock, because saves of any context ask for it on their queues and two logs must never append to the same file
+    @synchronized (self) {
+        if (_changeLog == nil && self.changeTrackingEnabled) {
+            NSURL *url = nil;
+            if (self.storeUrl != nil) {
+                url = [NSURL fileURLWithPath:[self.storeUrl.path stringByAppendingString:@".changes"] isDirectory:NO];
+            }
+            _changeLog = [[INCoreDataChangeLog alloc] initWithUrl:url];
+        }
+        return _changeLog;
+    }
+}
+
+- (void)contextDidSave:(NSNotification *)notification {
+    // posted on the queues of all contexts, while the stack may be replaced on the main thread
+    NSManagedObjectContext *writerContext = nil;
+    NSPersistentStoreCoordinator *persistentStoreCoordinator = nil;
+    @synchronized (self) {
+        writerContext = _writerContext;
+        persistentStoreCoordinator = _persistentStoreCoordinator;
+    }
+    
+    NSManagedObjectContext *context = notification.object;
+    if (context == writerContext) {
+        [self writerContextDidSave:notification];
+    }
+    
+    // only saves to the store are changes, saves of child contexts are not persisted yet
+    if (context.parentContext != nil || persistentStoreCoordinator == nil || context.persistentStoreCoordinator != persistentStoreCoordinator) {
+        return;
+    }
+    NSDictionary *userInfo = notification.userInfo;
+    NSArray *insertedObjectIDs = [[userInfo[NSInsertedObjectsKey] valueForKey:@"objectID"] allObjects];
+    NSArray *updatedObjectIDs = [[userInfo[NSUpdatedObjectsKey] valueForKey:@"objectID"] allObjects];
+    NSArray *deletedObjectIDs = [[userInfo[NSDeletedObjectsKey] valueForKey:@"objectID"] allObjects];
+    if (insertedObjectIDs.count + updatedObjectIDs.count + deletedObjectIDs.count > 0) {
+        [self.changeLog appendInsertedObjectIDs:insertedObjectIDs updatedObjectIDs:updatedObjectIDs deletedObjectIDs:deletedObjectIDs];
+    }
+}
+
+
+#pragma mark - Store configuration
+
+- (NSDictionary *)storeOptionsByAddingOptions:(NSDictionary *)options pragmas:(NSDictionary *)pragmas {
+    INCoreDataStoreConfiguration *configuration = (self.storeConfiguration != nil) ? self.storeConfiguration : [INCoreDataStoreConfiguration defaultConfiguration];
+    return [configuration storeOptionsByAddingOptions:options pragmas:pragmas];
+}
+
 
 #pragma mark - Version
 
 - (NSInteger)storeVersion {
-    return [NSManagedObjectModel versionNumberOfModelNamed:self.modelName forStoreAtUrl:self.storeUrl];
+    if (self.storeType == INCoreDataStoreTypeInMemory) {
+        // an in-memory store only exists while its coordinator does
+        NSPersistentStore *store = [_persistentStoreCoordinator.persistentStores lastObject];
+        if (store == nil) {
+            return INManagedObjectModelVersionNone;
+        }
+        return [NSManagedObjectModel versionNumberOfModelNamed:self.modelName forStoreMetadata:[_persistentStoreCoordinator metadataForPersistentStore:store]];
+    }
+    return [NSManagedObjectModel versionNumberOfModelNamed:self.modelName forStoreAtUrl:self.storeUrl options:[self storeOptionsByAddingOptions:nil pragmas:nil]];
 }
 
 - (NSInteger)modelVersion {
@@ -87,8 +325,9 @@
 }
 
 - (BOOL)storeExists {
-    // the sqlite file should exist on the given path if the store has prior been created
-    return [[NSFileManager defaultManager] fileExistsAtPath:self.storeUrl.path];
+    // the sqlite file should exist on the given path if the store has prior been created,
+    // an in-memory store never exists prior to its coordinator and therefore never needs a migration
+    return self.storeUrl != nil && [[NSFileManager defaultManager] fileExistsAtPath:self.storeUrl.path];
 }
 
 
@@ -100,17 +339,34 @@
         return NO;
     }
     
-    // Create the persistent store coordinator which uses the current model.
+    // Compare the store's metadata with the current model, which needs no store to be opened.
+    // The fingerprint of the model version is used if known, so not even the model has to be loaded.
+    NSDictionary *metadata = [NSManagedObjectModel metadataForStoreAtUrl:self.storeUrl];
+    if (metadata != nil) {
+        NSInteger versionNumber = (self.versionForNewModel > 0) ? self.versionForNewModel : [self modelVersion];
+        NSDictionary *modelHashes = [NSManagedObjectModel entityVersionHashesOfModelNamed:self.modelName version:versionNumber];
+        if (modelHashes != nil) {
+            return ![metadata[NSStoreModelVersionHashesKey] isEqualToDictionary:modelHashes];
+        }
+        return ![self.managedObjectModel isCompatibleWithStoreMetadata:metadata];
+    }
+    
+    // Reading the store's meta data failed, i.e. because of a corrupted store,
+    // so create the persistent store coordinator which uses the current model.
     // If this fails and no store coordinator is returned then the store and the current model are incompatible
     // and therefore needs an update.
-    // This approach may be more expansive than only comparing the meta data, but reading the store's meta data
-    // often results in an I/O exception because of a corrupted store, thus this is safer.
-    // However, if no migration is needed, which should be in most of the tries,
-    // the store is already created and no extra work is done.
     return self.persistentStoreCoordinator == nil;
 }
 
 - (BOOL)performMigration:(void (^)(NSInteger fromVersion, NSInteger toVersion, BOOL successfullyMigrated))progressBlock {
+    return [self performMigrationWithProgress:^(NSInteger fromVersion, NSInteger toVersion, unsigned long long bytesProcessed, BOOL successfullyMigrated) {
+        if (progressBlock != nil) {
+            progressBlock(fromVersion, toVersion, successfullyMigrated);
+        }
+    }];
+}
+
+- (BOOL)performMigrationWithProgress:(void (^)(NSInteger fromVersion, NSInteger toVersion, unsigned long long bytesProcessed, BOOL successfullyMigrated))progressBlock {
     // get store and model version numbers
     NSInteger storeVersion = [self storeVersion];
     NSInteger desiredModelVersion = [self modelVersion];
@@ -120,38 +376,265 @@
         return NO;
     }
     
+    // close all connections to the store, which will be replaced
+    self.persistentStoreCoordinator = nil;
+    [self resetContexts];
+    self.migrationCancelled = NO;
+    
+    return [self migrateStoreAtUrl:self.storeUrl fromVersion:storeVersion toVersion:desiredModelVersion progress:progressBlock];
+}
+
+- (void)performMigrationInBackground:(void (^)(float progress))progressBlock completion:(void (^)(BOOL successfullyMigrated, BOOL cancelled))completion {
+    NSInteger storeVersion = [self storeVersion];
+    NSInteger desiredModelVersion = [self modelVersion];
+    if (self.isMigrating || storeVersion == INManagedObjectModelVersionNone || desiredModelVersion <= storeVersion) {
+        if (completion != nil) {
+            dispatch_async(dispatch_get_main_queue(), ^{
+                completion(NO, NO);
+            });
+        }
+        return;
+    }
+    
+    self.migrating = YES;
+    self.migrationCancelled = NO;
+    self.migrationProgressBlock = progressBlock;
+    
+    // Close all connections to the store here on the main thread, which won't be touched until the migrated store replaces it.
+    // The background queue only works with files, so it never changes the stack's properties.
+    // Workers or imports may still hold contexts of the old coordinator, without its store their late saves fail instead of being lost with the replaced store.
+    NSPersistentStoreCoordinator *persistentStoreCoordinator = nil;
+    @synchronized (self) {
+        persistentStoreCoordinator = _persistentStoreCoordinator;
+        _persistentStoreCoordinator = nil;
+    }
+    [self resetContexts];
+    self.managedObjectModel = nil;
+    for (NSPersistentStore *store in persistentStoreCoordinator.persistentStores) {
+        [persistentStoreCoordinator removePersistentStore:store error:NULL];
+    }
+    
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        NSFileManager *fileManager = [NSFileManager defaultManager];
+        // the hidden staging directory must not match the store's file name prefix
+        NSString *stagingDirectoryName = [NSString stringWithFormat:@".%@.staging", self.storeUrl.lastPathComponent];
+        NSURL *stagingDirectoryUrl = [[self.storeUrl URLByDeletingLastPathComponent] URLByAppendingPathComponent:stagingDirectoryName isDirectory:YES];
+        NSURL *stagingUrl = [stagingDirectoryUrl URLByAppendingPathComponent:self.storeUrl.lastPathComponent isDirectory:NO];
+        
+        // Write back the store's journal, so the store is a single file which can be replaced with one atomic move.
+        // Then migrate a copy of it, a crash or a cancellation will leave the original store untouched.
+        [fileManager removeItemAtURL:stagingDirectoryUrl error:NULL];
+        BOOL success = [self checkpointStoreAtUrl:self.storeUrl]
+            && [fileManager createDirectoryAtURL:stagingDirectoryUrl withIntermediateDirectories:YES attributes:nil error:NULL]
+            && [self copyStoreFilesToUrl:stagingDirectoryUrl]
+            && [self migrateStoreAtUrl:stagingUrl fromVersion:storeVersion toVersion:desiredModelVersion progress:nil]
+            && !self.migrationCancelled
+            && [self checkpointStoreAtUrl:stagingUrl]
+            && [fileManager replaceItemAtURL:self.storeUrl withItemAtURL:stagingUrl backupItemName:nil options:0 resultingItemURL:NULL error:NULL];
+        [fileManager removeItemAtURL:stagingDirectoryUrl error:NULL];
+        
+        BOOL cancelled = self.migrationCancelled;
+        dispatch_async(dispatch_get_main_queue(), ^{
+            self.migrating = NO;
+            self.migrationProgressBlock = nil;
+            if (completion != nil) {
+                completion(success && !cancelled, cancelled);
+            }
+        });
+    });
+}
+
+- (void)cancelMigration {
+    if (!self.isMigrating) {
+        return;
+    }
+    self.migrationCancelled = YES;
+    NSError *error = [NSError errorWithDomain:NSCocoaErrorDomain code:NSUserCancelledError userInfo:nil];
+    [self.currentMigrationManager cancelMigrationWithError:error];
+}
+
+- (BOOL)checkpointStoreAtUrl:(NSURL *)storeUrl {
+    // opening the store in the rollback journal mode writes back and removes a write-ahead log
+    NSInteger versionNumber = [NSManagedObjectModel versionNumberOfModelNamed:self.modelName forStoreAtUrl:storeUrl options:[self storeOptionsByAddingOptions:nil pragmas:nil]];
+    NSManagedObjectModel *model = [NSManagedObjectModel sharedModelNamed:self.modelName version:versionNumber];
+    if (model == nil) {
+        return NO;
+    }
+    NSPersistentStoreCoordinator *persistentStoreCoordinator = [[NSPersistentStoreCoordinator alloc] initWithManagedObjectModel:model];
+    NSDictionary *options = [self storeOptionsByAddingOptions:nil pragmas:@{@"journal_mode": @"DELETE"}];
+    NSPersistentStore *store = [persistentStoreCoordinator addPersistentStoreWithType:NSSQLiteStoreType configuration:nil URL:storeUrl options:options error:NULL];
+    return store != nil && [persistentStoreCoordinator removePersistentStore:store error:NULL];
+}
+
+- (BOOL)migrateStoreAtUrl:(NSURL *)storeUrl fromVersion:(NSInteger)storeVersion toVersion:(NSInteger)desiredModelVersion progress:(void (^)(NSInteger fromVersion, NSInteger toVersion, unsigned long long bytesProcessed, BOOL successfullyMigrated))progressBlock {
+    // plan the migration with as few steps as possible
+    NSArray *plan = [self migrationPlanFromVersion:storeVersion toVersion:desiredModelVersion];
+    self.migrationStepCount = plan.count;
+    
     // perform updates
-    for (NSInteger nextVersion = storeVersion + 1; nextVersion <= desiredModelVersion; ++nextVersion) {
-        BOOL success = [self migrateStoreToVersion:nextVersion];
-        if (progressBlock != nil) {
-            progressBlock(nextVersion - 1, nextVersion, success);
+    unsigned long long bytesProcessed = 0;
+    for (INCoreDataMigrationStep *step in plan) {
+        if (self.migrationCancelled) {
+            return NO;
         }
+        self.migrationStepIndex = [plan indexOfObject:step];
+        bytesProcessed += INStoreFileSize(storeUrl);
+        BOOL success = [self migrateStoreAtUrl:storeUrl withStep:step];
         if (!success) {
-            // migration failed
-            return NO;
+            // The direct migration failed, so fall back to migrate the versions of this step one by one.
+            // Core Data's automatic migration reports no progress and can't be cancelled, so cancelling takes effect after each version.
+            for (NSInteger nextVersion = step.sourceVersion + 1; nextVersion <= step.destinationVersion && !self.migrationCancelled; ++nextVersion) {
+                success = [self migrateStoreAtUrl:storeUrl toVersion:nextVersion];
+                if (progressBlock != nil) {
+                    progressBlock(nextVersion - 1, nextVersion, bytesProcessed, success);
+                }
+                if (!success) {
+                    // migration failed
+                    return NO;
+                }
+            }
+        } else if (progressBlock != nil) {
+            progressBlock(step.sourceVersion, step.destinationVersion, bytesProcessed, YES);
+        }
+        [self reportMigrationProgress:1.0f];
+    }
+    
+    return !self.migrationCancelled;
+}
+
+- (void)reportMigrationProgress:(float)stepProgress {
+    void (^progressBlock)(float) = self.migrationProgressBlock;
+    if (progressBlock == nil || self.migrationStepCount == 0) {
+        return;
+    }
+    float progress = (self.migrationStepIndex + stepProgress) / self.migrationStepCount;
+    dispatch_async(dispatch_get_main_queue(), ^{
+        progressBlock(progress);
+    });
+}
+
+- (void)observeValueForKeyPath:(NSString *)keyPath ofObject:(id)object change:(NSDictionary *)change context:(void *)context {
+    if (context == INCoreDataManagerMigrationProgressContext) {
+        [self reportMigrationProgress:[(NSMigrationManager *)object migrationProgress]];
+    } else {
+        [super observeValueForKeyPath:keyPath ofObject:object change:change context:context];
+    }
+}
+
+- (NSArray *)migrationPlanFromVersion:(NSInteger)sourceVersion toVersion:(NSInteger)destinationVersion {
+    NSArray *bundles = @[[NSBundle mainBundle]];
+    
+    // Custom mapping models for single version steps must not be skipped by an inferred mapping over multiple versions,
+    // so remember in which steps one is available.
+    NSMutableIndexSet *customSteps = [NSMutableIndexSet indexSet];
+    for (NSInteger version = sourceVersion; version < destinationVersion; ++version) {
+        NSManagedObjectModel *fromModel = [NSManagedObjectModel sharedModelNamed:self.modelName version:version];
+        NSManagedObjectModel *toModel = [NSManagedObjectModel sharedModelNamed:self.modelName version:version + 1];
+        if ([NSMappingModel mappingModelFromBundles:bundles forSourceModel:fromModel destinationModel:toModel] != nil) {
+            [customSteps addIndex:version];
+        }
+    }
+    
+    // find the farthest version reachable from the current one by either a custom or an inferred mapping model
+    NSMutableArray *plan = [NSMutableArray array];
+    NSInteger fromVersion = sourceVersion;
+    while (fromVersion < destinationVersion) {
+        NSManagedObjectModel *fromModel = [NSManagedObjectModel sharedModelNamed:self.modelName version:fromVersion];
+        INCoreDataMigrationStep *step = nil;
+        for (NSInteger toVersion = destinationVersion; toVersion > fromVersion && step == nil; --toVersion) {
+            NSManagedObjectModel *toModel = [NSManagedObjectModel sharedModelNamed:self.modelName version:toVersion];
+            NSMappingModel *mappingModel = [NSMappingModel mappingModelFromBundles:bundles forSourceModel:fromModel destinationModel:toModel];
+            BOOL skipsCustomStep = [customSteps countOfIndexesInRange:NSMakeRange(fromVersion, toVersion - fromVersion)] > 0;
+            if (mappingModel == nil && !skipsCustomStep) {
+                mappingModel = [NSMappingModel inferredMappingModelForSourceModel:fromModel destinationModel:toModel error:NULL];
+            }
+            if (mappingModel != nil) {
+                step = [[INCoreDataMigrationStep alloc] init];
+                step.sourceVersion = fromVersion;
+                step.destinationVersion = toVersion;
+                step.mappingModel = mappingModel;
+            }
+        }
+        if (step == nil) {
+            // no mapping model found, leave this version step to the automatic migration
+            step = [[INCoreDataMigrationStep alloc] init];
+            step.sourceVersion = fromVersion;
+            step.destinationVersion = fromVersion + 1;
+        }
+        [plan addObject:step];
+        fromVersion = step.destinationVersion;
+    }
+    return plan;
+}
+
+- (BOOL)migrateStoreAtUrl:(NSURL *)storeUrl withStep:(INCoreDataMigrationStep *)step {
+    if (step.mappingModel == nil) {
+        return NO;
+    }
+    
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+    NSManagedObjectModel *sourceModel = [NSManagedObjectModel sharedModelNamed:self.modelName version:step.sourceVersion];
+    NSManagedObjectModel *destinationModel = [NSManagedObjectModel sharedModelNamed:self.modelName version:step.destinationVersion];
+    
+    // Write back the store's journal, so all committed transactions are in the store file which will be replaced,
+    // and keep reading it in the rollback journal mode, so no new write-ahead log is created.
+    if (![self checkpointStoreAtUrl:storeUrl]) {
+        return NO;
+    }
+    
+    // migrate into a temporary store beside the current one, without a journal so it's only a single file
+    NSURL *temporaryUrl = [NSURL fileURLWithPath:[storeUrl.path stringByAppendingString:@".migration"] isDirectory:NO];
+    for (NSURL *url in INStoreFileUrls(temporaryUrl)) {
+        [fileManager removeItemAtURL:url error:NULL];
+    }
+    NSDictionary *sourceOptions = [self storeOptionsByAddingOptions:nil pragmas:@{@"journal_mode": @"DELETE"}];
+    NSDictionary *destinationOptions = [self storeOptionsByAddingOptions:nil pragmas:@{@"journal_mode": @"DELETE"}];
+    NSMigrationManager *migrationManager = [[NSMigrationManager alloc] initWithSourceModel:sourceModel destinationModel:destinationModel];
+    [migrationManager addObserver:self forKeyPath:@"migrationProgress" options:0 context:INCoreDataManagerMigrationProgressContext];
+    self.currentMigrationManager = migrationManager;
+    BOOL migrated = [migrationManager migrateStoreFromURL:storeUrl type:NSSQLiteStoreType options:sourceOptions withMappingModel:step.mappingModel toDestinationURL:temporaryUrl destinationType:NSSQLiteStoreType destinationOptions:destinationOptions error:NULL];
+    self.currentMigrationManager = nil;
+    [migrationManager removeObserver:self forKeyPath:@"migrationProgress" context:INCoreDataManagerMigrationProgressContext];
+    if (!migrated) {
+        for (NSURL *url in INStoreFileUrls(temporaryUrl)) {
+            [fileManager removeItemAtURL:url error:NULL];
         }
+        return NO;
     }
     
+    // replace the old store, when this fails the old store's files are left untouched
+    if (![fileManager replaceItemAtURL:storeUrl withItemAtURL:temporaryUrl backupItemName:nil options:0 resultingItemURL:NULL error:NULL]) {
+        for (NSURL *url in INStoreFileUrls(temporaryUrl)) {
+            [fileManager removeItemAtURL:url error:NULL];
+        }
+        return NO;
+    }
+    
+    // any sidecar files left are those of the old store and must not be used with the new one
+    NSArray *storeFileUrls = INStoreFileUrls(storeUrl);
+    for (NSUInteger i = 1; i < storeFileUrls.count; ++i) {
+        [fileManager removeItemAtURL:storeFileUrls[i] error:NULL];
+    }
     return YES;
 }
 
-- (BOOL)migrateStoreToVersion:(NSInteger)versionNumber {
+- (BOOL)migrateStoreAtUrl:(NSURL *)storeUrl toVersion:(NSInteger)versionNumber {
     // setup
     NSError *error = nil;
     NSDictionary *options;
-    NSManagedObjectModel *destinationModel = [NSManagedObjectModel modelNamed:self.modelName version:versionNumber];
+    NSManagedObjectModel *destinationModel = [NSManagedObjectModel sharedModelNamed:self.modelName version:versionNumber];
     NSPersistentStoreCoordinator *persistentStoreCoordinator = [[NSPersistentStoreCoordinator alloc] initWithManagedObjectModel:destinationModel];
 
     // first try to migrate with a custom mapping model
-    options = [NSDictionary dictionaryWithObjectsAndKeys:@YES, NSMigratePersistentStoresAutomaticallyOption, @NO, NSInferMappingModelAutomaticallyOption, nil];
-    if ([persistentStoreCoordinator addPersistentStoreWithType:NSSQLiteStoreType configuration:nil URL:self.storeUrl options:options error:&error] != nil) {
+    options = [self storeOptionsByAddingOptions:@{NSMigratePersistentStoresAutomaticallyOption: @YES, NSInferMappingModelAutomaticallyOption: @NO} pragmas:nil];
+    if ([persistentStoreCoordinator addPersistentStoreWithType:NSSQLiteStoreType configuration:nil URL:storeUrl options:options error:&error] != nil) {
         // migration successfully
         return YES;
     }
 
     // no mapping model could be found, so try to use the automatic mapping model creation
-    options = [NSDictionary dictionaryWithObjectsAndKeys:@YES, NSMigratePersistentStoresAutomaticallyOption, @YES, NSInferMappingModelAutomaticallyOption, nil];
-    if ([persistentStoreCoordinator addPersistentStoreWithType:NSSQLiteStoreType configuration:nil URL:self.storeUrl options:options error:&error] != nil) {
+    options = [self storeOptionsByAddingOptions:@{NSMigratePersistentStoresAutomaticallyOption: @YES, NSInferMappingModelAutomaticallyOption: @YES} pragmas:nil];
+    if ([persistentStoreCoordinator addPersistentStoreWithType:NSSQLiteStoreType configuration:nil URL:storeUrl options:options error:&error] != nil) {
         // migration successfully
         return YES;
     }
@@ -164,49 +647,89 @@
 #pragma mark - Store manipulation
 
 - (BOOL)duplicateStoreToUrl:(NSURL *)url {
+    if (self.storeType == INCoreDataStoreTypeInMemory) {
+        return NO;
+    }
+    
     // close all connections to the store
     self.persistentStoreCoordinator = nil;
-    self.managedObjectContext = nil;
+    [self resetContexts];
     self.managedObjectModel = nil;
     
-    // copy all corresponding files
-    NSString *matchingFilename = [NSString stringWithFormat:@"%@.sqlite", self.modelName];
-    NSFileManager *fileManager = [NSFileManager defaultManager];
-    NSString *sourcePath = [[self.storeUrl URLByDeletingLastPathComponent] path];
-    NSString *destinationPath = [url path];
-    NSDirectoryEnumerator *filesEnumerator = [fileManager enumeratorAtPath:sourcePath];
-    NSString *file;
-    while (file = [filesEnumerator nextObject]) {
-        if ([file hasPrefix:matchingFilename]) {
-            NSString *sourceFilePath = [sourcePath stringByAppendingPathComponent:file];
-            NSString *destinationFilePath = [destinationPath stringByAppendingPathComponent:file];
-            NSError *error;
-            if (![fileManager copyItemAtPath:sourceFilePath toPath:destinationFilePath error:&error]) {
-                return NO;
-            }
+    return [self copyStoreFilesToUrl:url];
+}
+
+- (BOOL)copyStoreFilesToUrl:(NSURL *)url {
+    // copy only the store file and the files SQLite creates beside it
+    for (NSURL *storeFileUrl in INStoreFileUrls(self.storeUrl)) {
+        if (![[NSFileManager defaultManager] fileExistsAtPath:storeFileUrl.path]) {
+            continue;
+        }
+        NSString *destinationFilePath = [url.path stringByAppendingPathComponent:storeFileUrl.lastPathComponent];
+        if (!INCopyFile(storeFileUrl.path, destinationFilePath)) {
+            return NO;
         }
     }
     return YES;
 }
 
+- (BOOL)backupStoreToUrl:(NSURL *)url {
+    if (self.storeType == INCoreDataStoreTypeInMemory) {
+        return NO;
+    }
+    
+    // a write-ahead log left from a former store at the destination would be applied to the backup
+    NSArray *destinationFileUrls = INStoreFileUrls(url);
+    for (NSUInteger i = 1; i < destinationFileUrls.count; ++i) {
+        [[NSFileManager defaultManager] removeItemAtURL:destinationFileUrls[i] error:NULL];
+    }
+    
+    sqlite3 *source = NULL;
+    sqlite3 *destination = NULL;
+    BOOL success = NO;
+    if (sqlite3_open_v2(self.storeUrl.path.fileSystemRepresentation, &source, SQLITE_OPEN_READWRITE, NULL) == SQLITE_OK
+        && sqlite3_open_v2(url.path.fileSystemRepresentation, &destination, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, NULL) == SQLITE_OK) {
+        sqlite3_backup *backup = sqlite3_backup_init(destination, "main", source, "main");
+        if (backup != NULL) {
+            // Copy a few pages at once, so other connections to the store are able to write inbetween.
+            // A busy store would restart the backup with each write, so after a while copy the remaining pages in one step.
+            CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+            int retries = 0;
+            int result;
+            do {
+                BOOL stepwise = (CFAbsoluteTimeGetCurrent() - startTime < INStoreBackupStepwiseDuration);
+                result = sqlite3_backup_step(backup, stepwise ? INStoreBackupPagesPerStep : -1);
+                if (result == SQLITE_BUSY || result == SQLITE_LOCKED) {
+                    if (++retries > INStoreBackupMaximumRetries) {
+                        break;
+                    }
+                    sqlite3_sleep(INStoreBackupRetryDelay);
+                }
+            } while (result == SQLITE_OK || result == SQLITE_BUSY || result == SQLITE_LOCKED);
+            success = (sqlite3_backup_finish(backup) == SQLITE_OK && result == SQLITE_DONE);
+        }
+    }
+    sqlite3_close(destination);
+    sqlite3_close(source);
+    return success;
+}
+
 - (BOOL)deleteStore {
     // close all connections to the store
     self.persistentStoreCoordinator = nil;
-    self.managedObjectContext = nil;
+    [self resetContexts];
     self.managedObjectModel = nil;
     
-    // delete all corresponding files
-    NSString *matchingFilename = [NSString stringWithFormat:@"%@.sqlite", self.modelName];
+    if (self.storeType == INCoreDataStoreTypeInMemory) {
+        // the store is gone with its coordinator
+        return YES;
+    }
+    
+    // delete only the store file and the files SQLite creates beside it
     NSFileManager *fileManager = [NSFileManager defaultManager];
-    NSString *path = [[self.storeUrl URLByDeletingLastPathComponent] path];
-    NSDirectoryEnumerator *filesEnumerator = [fileManager enumeratorAtPath:path];
-    NSString *file;
-    while (file = [filesEnumerator nextObject]) {
-        if ([file hasPrefix:matchingFilename]) {
-            NSString *filePath = [path stringByAppendingPathComponent:file];
-            if (![fileManager removeItemAtPath:filePath error:NULL]) {
-                return NO;
-            }
+    for (NSURL *storeFileUrl in INStoreFileUrls(self.storeUrl)) {
+        if ([fileManager fileExistsAtPath:storeFileUrl.path] && ![fileManager removeItemAtURL:storeFileUrl error:NULL]) {
+            return NO;
         }
     }
     return YES;
@@ -215,6 +738,174 @@
 
 #pragma mark - core data stack
 
+- (void)resetContexts {
+    if (_mainContext != nil) {
+        [[NSNotificationCenter defaultCenter] removeObserver:self name:NSManagedObjectContextWillSaveNotification object:_mainContext];
+    }
+    self.managedObjectContext = nil;
+    self.saveScheduler = nil;
+    self.mainContext = nil;
+    @synchronized (self) {
+        if (_writerContext != nil && !self.changeTrackingEnabled) {
+            [[NSNotificationCenter defaultCenter] removeObserver:self name:NSManagedObjectContextDidSaveNotification object:_writerContext];
+        }
+        _writerContext = nil;
+    }
+}
+
+- (NSManagedObjectContext *)writerContext {
+    // created within a lock, because saves and worker contexts ask for it on background queues
+    @synchronized (self) {
+        if (self.isMigrating) {
+            // the stack stays closed until a background migration has replaced the store
+            return nil;
+        }
+        if (_writerContext != nil) {
+            return _writerContext;
+        }
+        
+        NSPersistentStoreCoordinator *coordinator = self.persistentStoreCoordinator;
+        if (coordinator != nil) {
+            _writerContext = [[NSManagedObjectContext alloc] initWithConcurrencyType:NSPrivateQueueConcurrencyType];
+            _writerContext.persistentStoreCoordinator = coordinator;
+            _writerContext.mergePolicy = NSMergeByPropertyObjectTrumpMergePolicy;
+            // belongs to this writer, so blocks still running on a replaced writer never touch the batch of the new one
+            objc_setAssociatedObject(_writerContext, pendingSaveCompletionsKey, [NSMutableArray array], OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+            
+            // whatever is written to the store will be merged into the main context,
+            // with change tracking all saves are already observed
+            if (!self.changeTrackingEnabled) {
+                [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(writerContextDidSave:) name:NSManagedObjectContextDidSaveNotification object:_writerContext];
+            }
+        }
+        return _writerContext;
+    }
+}
+
+- (NSManagedObjectContext *)mainContext {
+    if (_mainContext != nil) {
+        return _mainContext;
+    }
+    
+    NSManagedObjectContext *writerContext = self.writerContext;
+    if (writerContext != nil) {
+        _mainContext = [[NSManagedObjectContext alloc] initWithConcurrencyType:NSMainQueueConcurrencyType];
+        _mainContext.parentContext = writerContext;
+        _mainContext.mergePolicy = NSMergeByPropertyObjectTrumpMergePolicy;
+        [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(mainContextWillSave:) name:NSManagedObjectContextWillSaveNotification object:_mainContext];
+    }
+    return _mainContext;
+}
+
+- (void)mainContextWillSave:(NSNotification *)notification {
+    // Inserted objects get their permanent IDs before being pushed to the writer, otherwise merging the writer's save
+    // would bring them back into the main context as duplicates with the permanent IDs.
+    NSManagedObjectContext *mainContext = notification.object;
+    NSArray *insertedObjects = [mainContext.insertedObjects allObjects];
+    if (insertedObjects.count > 0) {
+        [mainContext obtainPermanentIDsForObjects:insertedObjects error:NULL];
+    }
+}
+
+- (INCoreDataSaveScheduler *)saveScheduler {
+    if (_saveScheduler != nil) {
+        return _saveScheduler;
+    }
+    
+    NSManagedObjectContext *mainContext = self.mainContext;
+    if (mainContext != nil) {
+        _saveScheduler = [[INCoreDataSaveScheduler alloc] initWithContext:mainContext];
+        // the main context's saves are pushed to the store with the batched saves of the writer context
+        __weak INCoreDataManager *weakSelf = self;
+        _saveScheduler.parentSaveHandler = ^(void (^completion)(BOOL success)) {
+            [weakSelf scheduleWriterSaveWithCompletion:^(BOOL success, NSError *error) {
+                completion(success);
+            }];
+        };
+    }
+    return _saveScheduler;
+}
+
+- (NSManagedObjectContext *)newWorkerContext {
+    // workers save directly into the writer context, so they never wait for the main queue
+    NSManagedObjectContext *writerContext = self.writerContext;
+    if (writerContext == nil) {
+        return nil;
+    }
+    NSManagedObjectContext *workerContext = [[NSManagedObjectContext alloc] initWithConcurrencyType:NSPrivateQueueConcurrencyType];
+    workerContext.parentContext = writerContext;
+    workerContext.mergePolicy = NSMergeByPropertyObjectTrumpMergePolicy;
+    workerContext.undoManager = nil;
+    return workerContext;
+}
+
+- (void)saveContext:(NSManagedObjectContext *)context completion:(void (^)(BOOL success, NSError *error))completion {
+    [context performBlock:^{
+        NSError *error = nil;
+        if (context.hasChanges && ![context save:&error]) {
+            if (completion != nil) {
+                dispatch_async(dispatch_get_main_queue(), ^{
+                    completion(NO, error);
+                });
+            }
+            return;
+        }
+        
+        if (context.parentContext != nil && context.parentContext != self.writerContext) {
+            // the main context or a context below it, continue with the parent
+            [self saveContext:context.parentContext completion:completion];
+        } else {
+            [self scheduleWriterSaveWithCompletion:completion];
+        }
+    }];
+}
+
+- (void)scheduleWriterSaveWithCompletion:(void (^)(BOOL success, NSError *error))completion {
+    NSManagedObjectContext *writerContext = self.writerContext;
+    if (writerContext == nil) {
+        // closed or migrating, there is no store to save to
+        if (completion != nil) {
+            dispatch_async(dispatch_get_main_queue(), ^{
+                completion(NO, nil);
+            });
+        }
+        return;
+    }
+    [writerContext performBlock:^{
+        // Saves which arrive before the writer's queue runs the save are batched into one store transaction,
+        // only the first one schedules the save.
+        NSMutableArray *pendingCompletions = objc_getAssociatedObject(writerContext, pendingSaveCompletionsKey);
+        BOOL saveScheduled = pendingCompletions.count > 0;
+        [pendingCompletions addObject:(completion != nil) ? [completion copy] : [NSNull null]];
+        if (saveScheduled) {
+            return;
+        }
+        
+        [writerContext performBlock:^{
+            NSArray *completions = [pendingCompletions copy];
+            [pendingCompletions removeAllObjects];
+            
+            NSError *error = nil;
+            BOOL success = !writerContext.hasChanges || [writerContext save:&error];
+            dispatch_async(dispatch_get_main_queue(), ^{
+                for (id completionBlock in completions) {
+                    if (completionBlock != [NSNull null]) {
+                        ((void (^)(BOOL, NSError *))completionBlock)(success, error);
+                    }
+                }
+            });
+        }];
+    }];
+}
+
+- (void)writerContextDidSave:(NSNotification *)notification {
+    NSManagedObjectContext *mainContext = _mainContext;
+    [mainContext performBlock:^{
+        [mainContext mergeChangesFromContextDidSaveNotification:notification];
+    }];
+}
+
+
 - (NSManagedObjectContext *)managedObjectContext {
     if (_managedObjectContext != nil) {
         return _managedObjectContext;
@@ -241,18 +932,37 @@
 }
 
 - (NSPersistentStoreCoordinator *)persistentStoreCoordinator {
-    if (_persistentStoreCoordinator != nil) {
+    // within the same lock as the writer context, because saves on any queue compare their coordinator with it
+    @synchronized (self) {
+        if (self.isMigrating) {
+            // no store is opened while a background migration replaces it
+            return nil;
+        }
+        if (_persistentStoreCoordinator != nil) {
+            return _persistentStoreCoordinator;
+        }
+        
+        // create the coordinator silently with no migration options, either the model is compatible or the creation failes
+        NSPersistentStoreCoordinator *persistentStoreCoordinator = [[NSPersistentStoreCoordinator alloc] initWithManagedObjectModel:self.managedObjectModel];
+        NSString *storeType = NSSQLiteStoreType;
+        NSDictionary *options = [self storeOptionsByAddingOptions:nil pragmas:nil];
+        if (self.storeType == INCoreDataStoreTypeInMemory) {
+            storeType = NSInMemoryStoreType;
+            options = nil;
+        }
+        // An error occured while adding the store, maybe a migration is needed.
+        // Without a usable store, keep no coordinator to indicate it needs to be migrated.
+        if ([persistentStoreCoordinator addPersistentStoreWithType:storeType configuration:nil URL:self.storeUrl options:options error:NULL] != nil) {
+            _persistentStoreCoordinator = persistentStoreCoordinator;
+        }
         return _persistentStoreCoordinator;
     }
-    
-    // create the coordinator silently with no migration options, either the model is compatible or the creation failes
-    _persistentStoreCoordinator = [[NSPersistentStoreCoordinator alloc] initWithManagedObjectModel:self.managedObjectModel];
-    if ([_persistentStoreCoordinator addPersistentStoreWithType:NSSQLiteStoreType configuration:nil URL:self.storeUrl options:nil error:NULL] == nil) {
-        // An error occured while adding the store, maybe a migration is needed.
-        // Without a usable store, delete the coordinator to indicate it needs to be migrated.
-        _persistentStoreCoordinator = nil;
+}
+
+- (void)setPersistentStoreCoordinator:(NSPersistentStoreCoordinator *)persistentStoreCoordinator {
+    @synchronized (self) {
+        _persistentStoreCoordinator = persistentStoreCoordinator;
     }
-    return _persistentStoreCoordinator;
 }
 
 
@@ -0,0 +1,129 @@
+// INCoreDataSaveScheduler.h
+//
+// Copyright (c) 2014 Sven Korset
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#import <Foundation/Foundation.h>
+
+
+@class NSManagedObjectContext;
+
+
+/// The time a change waits at most to be saved if no other time is given.
+static NSTimeInterval const INCoreDataSaveSchedulerDefaultMaximumDelay = 0.5;
+/// The number of changed objects which will be saved at once if no other number is given.
+static NSUInteger const INCoreDataSaveSchedulerDefaultMaximumPendingObjects = 500;
+
+
+/**
+ Coalesces the changes of a context into fewer saves.
+ 
+ Each save of a context connected to a SQLite store is a transaction with a sync to disk, so saving after each small change is expensive.
+ The scheduler observes its context's changes and saves them together, at the latest after the maximum delay
+ When the app goes into the background or terminates all pending changes will be saved immediately, within a background task unless running in an app extension.
+ When the app goes into the background or terminates all pending changes will be saved immediately.
+ If the context has parent contexts, they are saved asynchronously on their queues after the context's save,
+ so the context's queue never waits for the store, only flushAndWait waits for them.
+ 
+    INCoreDataSaveScheduler *scheduler = [[INCoreDataSaveScheduler alloc] initWithContext:manager.mainContext];
+    person.name = @"Bob"; // no need to save, the scheduler will do it
+    ...
+    [scheduler flush]; // save now, i.e. before a sync
+ */
+@interface INCoreDataSaveScheduler : NSObject
+
+/**
+ Initializes the scheduler for a context and starts observing its changes.
+ 
+ @param context The context whose changes to save. It has to use a queue concurrency type or be used on the main thread only.
+ @return The initialized instance.
+ */
+- (instancetype)initWithContext:(NSManagedObjectContext *)context;
+
+/// The context whose changes are saved.
+@property (nonatomic, strong, readonly) NSManagedObjectContext *context;
+
+/// The maximum time in seconds a change waits for the save, default is INCoreDataSaveSchedulerDefaultMaximumDelay.
+@property (atomic, assign) NSTimeInterval maximumDelay;
+
+/// The number of changed objects which will trigger a save, default is INCoreDataSaveSchedulerDefaultMaximumPendingObjects.
+@property (atomic, assign) NSUInteger maximumPendingObjects;
+
+/**
+ The block which saves the context's parents after the context has been saved, called on the context's queue.
+ 
+ The block has to save the parents without blocking and call the completion block when the changes are written.
+ If nil, each parent is saved on its own queue after its child, INCoreDataManager sets a block which batches the saves of its writer context.
+ flushAndWait doesn't use this block.
+ */
+@property (nonatomic, copy) void (^parentSaveHandler)(void (^completion)(BOOL success));
+
+
+/// @name Saving
+
+/**
+ Tells the scheduler the context has changes to save.
+ 
+ The changes of the context are observed, so this is only needed if the changes don't trigger a change notification.
+ */
+- (void)setNeedsSave;
+
+/**
+ Saves all pending changes on the context's queue without waiting.
+ */
+- (void)flush;
+
+/**
+ Saves all pending changes and waits until they are written.
+ 
+ @return True if there were no changes or they were saved, false on an error.
+ */
+- (BOOL)flushAndWait;
+
+
+/// @name Metrics
+
+/// The number of saves performed since the creation or the last reset of the metrics.
+@property (atomic, assign, readonly) NSUInteger transactionCount;
+
+/// The number of inserted, updated and deleted objects saved since the creation or the last reset of the metrics.
+@property (atomic, assign, readonly) NSUInteger objectCount;
+
+/**
+ Returns the number of saves per second since the creation or the last reset of the metrics.
+ 
+ @return The transactions per second.
+ */
+- (double)transactionsPerSecond;
+
+/**
+ Returns the mean number of objects per save since the creation or the last reset of the metrics.
+ 
+ @return The objects per transaction or 0 if there was no save.
+ */
+- (double)objectsPerTransaction;
+
+/**
+ Sets all metrics back to 0.
+ */
+- (void)resetMetrics;
+
+@end
@@ -0,0 +1,270 @@
+// INCoreDataSaveScheduler.m
+//
+// Copyright (c) 2014 Sven Korset
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#import "INCoreDataSaveScheduler.h"
+
+#import <CoreData/CoreData.h>
+#import <UIKit/UIKit.h>
+
+
+@interface INCoreDataSaveScheduler ()
+
+@property (nonatomic, strong, readwrite) NSManagedObjectContext *context;
+@property (atomic, assign, readwrite) NSUInteger transactionCount;
+@property (atomic, assign, readwrite) NSUInteger objectCount;
+@property (atomic, assign) CFAbsoluteTime metricsStartTime;
+
+// only accessed on the context's queue
+@property (nonatomic, assign) BOOL saveScheduled;
+@property (nonatomic, assign) BOOL immediateSaveScheduled;
+@property (nonatomic, assign) BOOL saving;
+
+@end
+
+
+@implementation INCoreDataSaveScheduler
+
+- (instancetype)initWithContext:(NSManagedObjectContext *)context {
+    self = [super init];
+    if (self == nil) return self;
+    
+    _context = context;
+    _maximumDelay = INCoreDataSaveSchedulerDefaultMaximumDelay;
+    _maximumPendingObjects = INCoreDataSaveSchedulerDefaultMaximumPendingObjects;
+    _metricsStartTime = CFAbsoluteTimeGetCurrent();
+    
+    NSNotificationCenter *notificationCenter = [NSNotificationCenter defaultCenter];
+    [notificationCenter addObserver:self selector:@selector(contextObjectsDidChange:) name:NSManagedObjectContextObjectsDidChangeNotification object:context];
+    [notificationCenter addObserver:self selector:@selector(applicationWillExit:) name:UIApplicationDidEnterBackgroundNotification object:nil];
+    [notificationCenter addObserver:self selector:@selector(applicationWillExit:) name:UIApplicationWillTerminateNotification object:nil];
+    
+    return self;
+}
+
+- (void)dealloc {
+    [[NSNotificationCenter defaultCenter] removeObserver:self];
+}
+
+- (void)performBlock:(void (^)(void))block wait:(BOOL)wait {
+    if (self.context.concurrencyType == NSConfinementConcurrencyType) {
+        // a context without a queue has to be used on the main thread
+        if (wait && [NSThread isMainThread]) {
+            block();
+        } else if (wait) {
+            dispatch_sync(dispatch_get_main_queue(), block);
+        } else {
+            dispatch_async(dispatch_get_main_queue(), block);
+        }
+    } else if (wait) {
+        [self.context performBlockAndWait:block];
+    } else {
+        [self.context performBlock:block];
+    }
+}
+
+
+#pragma mark - Saving
+
+- (void)contextObjectsDidChange:(NSNotification *)notification {
+    // posted on the context's queue
+    [self scheduleSave];
+}
+
+- (void)applicationWillExit:(NSNotification *)notification {
+    // App extensions have no shared application and can't extend their runtime, so they save without a background task.
+    // The application is looked up at runtime, because the class method is unavailable when compiling for extensions.
+    UIApplication *application = nil;
+    if ([UIApplication respondsToSelector:@selector(sharedApplication)] && ![[[NSBundle mainBundle] bundlePath].pathExtension isEqualToString:@"appex"]) {
+        application = [UIApplication performSelector:@selector(sharedApplication)];
+    }
+    if (application == nil) {
+        [self flushAndWait];
+        return;
+    }
+    
+    // finish the save even if the app gets suspended meanwhile
+    __block UIBackgroundTaskIdentifier taskIdentifier = [application beginBackgroundTaskWithExpirationHandler:^{
+        [application endBackgroundTask:taskIdentifier];
+        taskIdentifier = UIBackgroundTaskInvalid;
+    }];
+    [self flushAndWait];
+    if (taskIdentifier != UIBackgroundTaskInvalid) {
+        [application endBackgroundTask:taskIdentifier];
+    }
+}
+
+- (void)setNeedsSave {
+    [self performBlock:^{
+        [self scheduleSave];
+    } wait:NO];
+}
+
+- (void)scheduleSave {
+    if (self.saving) {
+        // the context posts changes while saving
+        return;
+    }
+    NSManagedObjectContext *context = self.context;
+    NSUInteger pendingObjects = context.insertedObjects.count + context.updatedObjects.count + context.deletedObjects.count;
+    if (pendingObjects == 0) {
+        return;
+    }
+    if (pendingObjects >= self.maximumPendingObjects) {
+        // called while the context processes its pending changes, so save after that
+        if (!self.immediateSaveScheduled) {
+            self.immediateSaveScheduled = YES;
+            [self performBlock:^{
+                self.immediateSaveScheduled = NO;
+                [self save];
+            } wait:NO];
+        }
+        return;
+    }
+    if (self.saveScheduled) {
+        // the changes will be saved with the already scheduled ones
+        return;
+    }
+    
+    self.saveScheduled = YES;
+    __weak INCoreDataSaveScheduler *weakSelf = self;
+    dispatch_time_t time = dispatch_time(DISPATCH_TIME_NOW, (int64_t)(self.maximumDelay * NSEC_PER_SEC));
+    dispatch_after(time, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        [weakSelf performBlock:^{
+            if (weakSelf.saveScheduled) {
+                [weakSelf save];
+            }
+        } wait:NO];
+    });
+}
+
+- (void)flush {
+    [self performBlock:^{
+        [self save];
+    } wait:NO];
+}
+
+- (BOOL)flushAndWait {
+    __block BOOL success;
+    [self performBlock:^{
+        NSManagedObjectContext *context = self.context;
+        BOOL hasChanges = context.hasChanges;
+        NSUInteger pendingObjects = context.insertedObjects.count + context.updatedObjects.count + context.deletedObjects.count;
+        success = [self saveContext];
+        // write the changes through all parents into the store before returning
+        for (NSManagedObjectContext *parentContext = context.parentContext; parentContext != nil && success; parentContext = parentContext.parentContext) {
+            [parentContext performBlockAndWait:^{
+                success = !parentContext.hasChanges || [parentContext save:NULL];
+            }];
+        }
+        if (success && hasChanges) {
+            [self countTransactionWithObjects:pendingObjects];
+        }
+    } wait:YES];
+    return success;
+}
+
+- (void)save {
+    // has to be called on the context's queue
+    NSManagedObjectContext *context = self.context;
+    NSUInteger pendingObjects = context.insertedObjects.count + context.updatedObjects.count + context.deletedObjects.count;
+    if (!context.hasChanges) {
+        self.saveScheduled = NO;
+        return;
+    }
+    if (![self saveContext]) {
+        return;
+    }
+    if (context.parentContext == nil) {
+        [self countTransactionWithObjects:pendingObjects];
+        return;
+    }
+    
+    // the parents are written asynchronously, so the context's queue doesn't wait for the store
+    void (^completion)(BOOL) = ^(BOOL success) {
+        if (success) {
+            [self countTransactionWithObjects:pendingObjects];
+        }
+    };
+    if (self.parentSaveHandler != nil) {
+        self.parentSaveHandler(completion);
+    } else {
+        [INCoreDataSaveScheduler saveParentOfContext:context completion:completion];
+    }
+}
+
+// Saves only the context itself, has to be called on the context's queue.
+- (BOOL)saveContext {
+    self.saveScheduled = NO;
+    NSManagedObjectContext *context = self.context;
+    if (!context.hasChanges) {
+        return YES;
+    }
+    self.saving = YES;
+    BOOL saved = [context save:NULL];
+    self.saving = NO;
+    return saved;
+}
+
+- (void)countTransactionWithObjects:(NSUInteger)objectCount {
+    @synchronized (self) {
+        self.transactionCount++;
+        self.objectCount += objectCount;
+    }
+}
+
++ (void)saveParentOfContext:(NSManagedObjectContext *)context completion:(void (^)(BOOL success))completion {
+    NSManagedObjectContext *parentContext = context.parentContext;
+    if (parentContext == nil) {
+        completion(YES);
+        return;
+    }
+    [parentContext performBlock:^{
+        if (parentContext.hasChanges && ![parentContext save:NULL]) {
+            completion(NO);
+            return;
+        }
+        [self saveParentOfContext:parentContext completion:completion];
+    }];
+}
+
+
+#pragma mark - Metrics
+
+- (double)transactionsPerSecond {
+    return self.transactionCount / MAX(CFAbsoluteTimeGetCurrent() - self.metricsStartTime, DBL_EPSILON);
+}
+
+- (double)objectsPerTransaction {
+    NSUInteger transactionCount = self.transactionCount;
+    return (transactionCount > 0) ? (double)self.objectCount / transactionCount : 0.0;
+}
+
+- (void)resetMetrics {
+    @synchronized (self) {
+        self.transactionCount = 0;
+        self.objectCount = 0;
+        self.metricsStartTime = CFAbsoluteTimeGetCurrent();
+    }
+}
+
+@end
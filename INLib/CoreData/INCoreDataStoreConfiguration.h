@@ -0,0 +1,127 @@
+// INCoreDataStoreConfiguration.h
+//
+// Copyright (c) 2014 Sven Korset
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#import <Foundation/Foundation.h>
+
+
+/// The journal mode of a SQLite store.
+typedef NS_ENUM(NSInteger, INStoreJournalMode) {
+    /// Core Data's default, which is the write-ahead log on iOS 7+.
+    INStoreJournalModeDefault = 0,
+    /// Write-ahead log, readers don't block writers.
+    INStoreJournalModeWAL,
+    /// Rollback journal which is deleted after each transaction.
+    INStoreJournalModeDelete,
+    /// Rollback journal which is truncated after each transaction.
+    INStoreJournalModeTruncate,
+};
+
+/// The level of syncing SQLite does to ensure the data is on disk.
+typedef NS_ENUM(NSInteger, INStoreSynchronousLevel) {
+    /// SQLite's default, which is full.
+    INStoreSynchronousLevelDefault = 0,
+    /// No syncing at all, the store may get corrupted on a power loss.
+    INStoreSynchronousLevelOff,
+    /// Syncs at critical moments only, safe in WAL mode but a power loss may roll back the last transactions.
+    INStoreSynchronousLevelNormal,
+    /// Syncs after each transaction.
+    INStoreSynchronousLevelFull,
+};
+
+
+/**
+ Tuning options of a SQLite store used by INCoreDataManager.
+ 
+ The options are mapped onto SQLite pragmas passed with NSSQLitePragmasOption and onto other store options.
+ Each option with its default value will leave the store's setting untouched.
+ 
+    INCoreDataStoreConfiguration *configuration = [INCoreDataStoreConfiguration writeHeavyConfiguration];
+    configuration.cacheSize = 8000;
+    manager.storeConfiguration = configuration;
+ */
+@interface INCoreDataStoreConfiguration : NSObject <NSCopying>
+
+/// @name Presets
+
+/**
+ Returns a configuration which leaves all settings to Core Data and SQLite.
+ 
+ @return A new configuration.
+ */
++ (instancetype)defaultConfiguration;
+
+/**
+ Returns a configuration for stores with heavy writes, i.e. while importing.
+ 
+ Uses the write-ahead log with the normal synchronous level, a large page cache and a large journal size limit,
+ so the write-ahead log isn't truncated too often.
+ 
+ @return A new configuration.
+ */
++ (instancetype)writeHeavyConfiguration;
+
+/**
+ Returns a configuration for stores which are mostly read.
+ 
+ Uses the write-ahead log with the full synchronous level, a large page cache and a small journal size limit.
+ 
+ @return A new configuration.
+ */
++ (instancetype)readMostlyConfiguration;
+
+
+/// @name Options
+
+/// The journal mode, default is INStoreJournalModeDefault.
+@property (nonatomic, assign) INStoreJournalMode journalMode;
+/// The synchronous level, default is INStoreSynchronousLevelDefault.
+@property (nonatomic, assign) INStoreSynchronousLevel synchronousLevel;
+/// The maximum size in bytes of a journal left on disk after a transaction, default is -1 for no limit.
+@property (nonatomic, assign) long long journalSizeLimit;
+/// The number of database pages held in memory, default is 0 to use SQLite's default.
+@property (nonatomic, assign) NSInteger cacheSize;
+/// True to vacuum the store when adding it to a coordinator, default is false.
+@property (nonatomic, assign) BOOL vacuumOnOpen;
+/// True to update the statistics of the store's indices when adding it to a coordinator, default is false.
+@property (nonatomic, assign) BOOL analyzeOnOpen;
+
+
+/// @name Store options
+
+/**
+ Returns the options to pass when adding the store to a coordinator.
+ 
+ @return The store options, which may be empty.
+ */
+- (NSDictionary *)storeOptions;
+
+/**
+ Returns the options to pass when adding the store to a coordinator merged with other options.
+ 
+ @param options Other store options, i.e. for migrating. May be nil.
+ @param pragmas SQLite pragmas which override those of this configuration. May be nil.
+ @return The store options, which may be empty.
+ */
+- (NSDictionary *)storeOptionsByAddingOptions:(NSDictionary *)options pragmas:(NSDictionary *)pragmas;
+
+@end
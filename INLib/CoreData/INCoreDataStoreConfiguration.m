@@ -0,0 +1,118 @@
+// INCoreDataStoreConfiguration.m
+//
+// Copyright (c) 2014 Sven Korset
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#import "INCoreDataStoreConfiguration.h"
+
+#import <CoreData/CoreData.h>
+
+
+@implementation INCoreDataStoreConfiguration
+
+#pragma mark - Presets
+
++ (instancetype)defaultConfiguration {
+    return [[self alloc] init];
+}
+
++ (instancetype)writeHeavyConfiguration {
+    INCoreDataStoreConfiguration *configuration = [[self alloc] init];
+    configuration.journalMode = INStoreJournalModeWAL;
+    configuration.synchronousLevel = INStoreSynchronousLevelNormal;
+    configuration.journalSizeLimit = 64 * 1024 * 1024;
+    configuration.cacheSize = 4000;
+    return configuration;
+}
+
++ (instancetype)readMostlyConfiguration {
+    INCoreDataStoreConfiguration *configuration = [[self alloc] init];
+    configuration.journalMode = INStoreJournalModeWAL;
+    configuration.synchronousLevel = INStoreSynchronousLevelFull;
+    configuration.journalSizeLimit = 4 * 1024 * 1024;
+    configuration.cacheSize = 8000;
+    return configuration;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self == nil) return self;
+    
+    _journalSizeLimit = -1;
+    
+    return self;
+}
+
+- (id)copyWithZone:(NSZone *)zone {
+    INCoreDataStoreConfiguration *configuration = [[[self class] allocWithZone:zone] init];
+    configuration.journalMode = self.journalMode;
+    configuration.synchronousLevel = self.synchronousLevel;
+    configuration.journalSizeLimit = self.journalSizeLimit;
+    configuration.cacheSize = self.cacheSize;
+    configuration.vacuumOnOpen = self.vacuumOnOpen;
+    configuration.analyzeOnOpen = self.analyzeOnOpen;
+    return configuration;
+}
+
+
+#pragma mark - Store options
+
+- (NSDictionary *)storeOptions {
+    return [self storeOptionsByAddingOptions:nil pragmas:nil];
+}
+
+- (NSDictionary *)storeOptionsByAddingOptions:(NSDictionary *)options pragmas:(NSDictionary *)pragmas {
+    NSMutableDictionary *allPragmas = [NSMutableDictionary dictionary];
+    switch (self.journalMode) {
+        case INStoreJournalModeWAL: allPragmas[@"journal_mode"] = @"WAL"; break;
+        case INStoreJournalModeDelete: allPragmas[@"journal_mode"] = @"DELETE"; break;
+        case INStoreJournalModeTruncate: allPragmas[@"journal_mode"] = @"TRUNCATE"; break;
+        case INStoreJournalModeDefault: break;
+    }
+    switch (self.synchronousLevel) {
+        case INStoreSynchronousLevelOff: allPragmas[@"synchronous"] = @"OFF"; break;
+        case INStoreSynchronousLevelNormal: allPragmas[@"synchronous"] = @"NORMAL"; break;
+        case INStoreSynchronousLevelFull: allPragmas[@"synchronous"] = @"FULL"; break;
+        case INStoreSynchronousLevelDefault: break;
+    }
+    if (self.journalSizeLimit >= 0) {
+        allPragmas[@"journal_size_limit"] = [NSString stringWithFormat:@"%lld", self.journalSizeLimit];
+    }
+    if (self.cacheSize != 0) {
+        allPragmas[@"cache_size"] = [NSString stringWithFormat:@"%ld", (long)self.cacheSize];
+    }
+    [allPragmas addEntriesFromDictionary:pragmas];
+    
+    NSMutableDictionary *storeOptions = [NSMutableDictionary dictionary];
+    if (allPragmas.count > 0) {
+        storeOptions[NSSQLitePragmasOption] = allPragmas;
+    }
+    if (self.vacuumOnOpen) {
+        storeOptions[NSSQLiteManualVacuumOption] = @YES;
+    }
+    if (self.analyzeOnOpen) {
+        storeOptions[NSSQLiteAnalyzeOption] = @YES;
+    }
+    [storeOptions addEntriesFromDictionary:options];
+    return storeOptions;
+}
+
+@end
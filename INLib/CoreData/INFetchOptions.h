@@ -0,0 +1,67 @@
+// INFetchOptions.h
+//
+// Copyright (c) 2014 Sven Korset
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#import <Foundation/Foundation.h>
+
+
+/// The fetch batch size used by the fetch helpers of NSManagedObject+INExtensions if no options are given.
+static NSUInteger const INFetchOptionsDefaultBatchSize = 50;
+
+
+/**
+ Options to tune the fetch requests of the fetch helpers in NSManagedObject+INExtensions.
+ 
+ The options are copied into each fetch request, a value of 0 or nil leaves the fetch request's default.
+ 
+    INFetchOptions *options = [INFetchOptions options];
+    options.sortDescriptors = @[[NSSortDescriptor sortDescriptorWithKey:@"name" ascending:YES]];
+    options.relationshipKeyPathsForPrefetching = @[@"address"];
+    NSArray *persons = [Person fetchWithPredicate:nil inContext:context options:options];
+ */
+@interface INFetchOptions : NSObject <NSCopying>
+
+/**
+ Returns new options with the default fetch batch size.
+ 
+ @return The new options.
+ */
++ (instancetype)options;
+
+/// The number of objects fetched at once when accessing the result, default is INFetchOptionsDefaultBatchSize.
+@property (nonatomic, assign) NSUInteger fetchBatchSize;
+/// The maximum number of objects to fetch, default is 0 for no limit.
+@property (nonatomic, assign) NSUInteger fetchLimit;
+/// The number of objects to skip, default is 0.
+@property (nonatomic, assign) NSUInteger fetchOffset;
+/// The sort descriptors of the result.
+@property (nonatomic, copy) NSArray *sortDescriptors;
+/// The relationship key paths whose objects should be fetched along with the result.
+@property (nonatomic, copy) NSArray *relationshipKeyPathsForPrefetching;
+/// The names of the properties to fetch, all properties are fetched if nil.
+@property (nonatomic, copy) NSArray *propertiesToFetch;
+/// True if the objects of the result should be faults, default is true.
+@property (nonatomic, assign) BOOL returnsObjectsAsFaults;
+/// True if unsaved changes of the context should be included, default is true.
+@property (nonatomic, assign) BOOL includesPendingChanges;
+
+@end
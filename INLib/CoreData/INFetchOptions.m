@@ -0,0 +1,57 @@
+// INFetchOptions.m
+//
+// Copyright (c) 2014 Sven Korset
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#import "INFetchOptions.h"
+
+
+@implementation INFetchOptions
+
++ (instancetype)options {
+    return [[self alloc] init];
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self == nil) return self;
+    
+    _fetchBatchSize = INFetchOptionsDefaultBatchSize;
+    _returnsObjectsAsFaults = YES;
+    _includesPendingChanges = YES;
+    
+    return self;
+}
+
+- (id)copyWithZone:(NSZone *)zone {
+    INFetchOptions *options = [[[self class] allocWithZone:zone] init];
+    options.fetchBatchSize = self.fetchBatchSize;
+    options.fetchLimit = self.fetchLimit;
+    options.fetchOffset = self.fetchOffset;
+    options.sortDescriptors = self.sortDescriptors;
+    options.relationshipKeyPathsForPrefetching = self.relationshipKeyPathsForPrefetching;
+    options.propertiesToFetch = self.propertiesToFetch;
+    options.returnsObjectsAsFaults = self.returnsObjectsAsFaults;
+    options.includesPendingChanges = self.includesPendingChanges;
+    return options;
+}
+
+@end
@@ -23,21 +23,40 @@
 
 #import <CoreData/CoreData.h>
 
+@class INFetchOptions;
+
+
+/// The number of records inserted between two saves of a bulk import if no batch size is given.
+static NSUInteger const INManagedObjectImportDefaultBatchSize = 500;
+
 
 @interface NSManagedObject (INExtensions)
 
 /**
  Returns the entity's name (name of class) as a string.
+ 
+ The name is only determined once per class.
 
  @return The entity name.
 */
 + (NSString *)entityName;
 
 
+/**
+ Returns the entity description of this class in the model of a context.
+ 
+ Uses the cached entityName, so no class name has to be created for the lookup.
+ 
+ @param context The context whose store coordinator's model contains the entity.
+ @return The entity description or nil if the model has no entity with this class' name.
+ */
++ (NSEntityDescription *)entityDescriptionInContext:(NSManagedObjectContext *)context;
+
+
 /**
  Creates a new entity for a managed object context which is also connected.
  
- It is only a shortcut for NSEntityDescription's insertNewObjectForEntityForName:inManagedObjectContext:.
+ It does the same as NSEntityDescription's insertNewObjectForEntityForName:inManagedObjectContext:, but with the cached entity description.
 
  @param context The context in which the object should be created.
  @return A new managed object of this class.
@@ -63,4 +82,138 @@
 - (void)addToContext:(NSManagedObjectContext *)context;
 
 
+/// @name Fetching
+
+// All fetch helpers fetch objects of this class' entity and take an options object to tune the fetch request.
+// If the options are nil the default options will be used, which have a fetch batch size of INFetchOptionsDefaultBatchSize.
+// On an error the helpers return nil, respectively 0 for a count.
+
+/**
+ Returns a new fetch request for this class' entity with the options applied.
+ 
+ @param context The context in whose model to find the entity.
+ @param options The options for the fetch request. May be nil.
+ @return A new fetch request.
+ */
++ (NSFetchRequest *)fetchRequestInContext:(NSManagedObjectContext *)context options:(INFetchOptions *)options;
+
+/**
+ Returns a predicate for a format with variables, i.e. 'name == $NAME', and substitutes the variables.
+ 
+ The format is parsed only once and the resulting predicate template is cached.
+ 
+ @param format The predicate format with $ variables.
+ @param variables The values for the variables in the format. May be nil if the format has no variables.
+ @return The predicate with the values substituted.
+ */
++ (NSPredicate *)predicateWithFormat:(NSString *)format substitutionVariables:(NSDictionary *)variables;
+
+/**
+ Fetches all objects of this entity.
+ 
+ @param context The context to fetch from.
+ @param options The options for the fetch request. May be nil.
+ @return The fetched objects.
+ */
++ (NSArray *)fetchAllInContext:(NSManagedObjectContext *)context options:(INFetchOptions *)options;
+
+/**
+ Fetches the objects of this entity matching a predicate.
+ 
+ @param predicate The predicate the objects have to match. May be nil to fetch all.
+ @param context The context to fetch from.
+ @param options The options for the fetch request. May be nil.
+ @return The fetched objects.
+ */
++ (NSArray *)fetchWithPredicate:(NSPredicate *)predicate inContext:(NSManagedObjectContext *)context options:(INFetchOptions *)options;
+
+/**
+ Fetches the objects of this entity matching a cached predicate template.
+ 
+    NSArray *persons = [Person fetchWithPredicateFormat:@"name == $NAME" substitutionVariables:@{@"NAME": name} inContext:context options:nil];
+ 
+ @param format The predicate format with $ variables.
+ @param variables The values for the variables in the format. May be nil if the format has no variables.
+ @param context The context to fetch from.
+ @param options The options for the fetch request. May be nil.
+ @return The fetched objects.
+ @see predicateWithFormat:substitutionVariables:
+ */
++ (NSArray *)fetchWithPredicateFormat:(NSString *)format substitutionVariables:(NSDictionary *)variables inContext:(NSManagedObjectContext *)context options:(INFetchOptions *)options;
+
+/**
+ Fetches the first object of this entity matching a predicate.
+ 
+ Use the options' sort descriptors to define which object is the first.
+ 
+ @param predicate The predicate the object has to match. May be nil.
+ @param context The context to fetch from.
+ @param options The options for the fetch request. May be nil.
+ @return The first object or nil if there is none.
+ */
++ (instancetype)fetchFirstWithPredicate:(NSPredicate *)predicate inContext:(NSManagedObjectContext *)context options:(INFetchOptions *)options;
+
+/**
+ Counts the objects of this entity matching a predicate without fetching them.
+ 
+ @param predicate The predicate the objects have to match. May be nil to count all.
+ @param context The context to count in.
+ @return The number of objects.
+ */
++ (NSUInteger)countWithPredicate:(NSPredicate *)predicate inContext:(NSManagedObjectContext *)context;
+
+/**
+ Fetches only the object IDs of the objects of this entity matching a predicate.
+ 
+ No property values are fetched.
+ 
+ @param predicate The predicate the objects have to match. May be nil to fetch all.
+ @param context The context to fetch from.
+ @param options The options for the fetch request. May be nil.
+ @return The NSManagedObjectID objects.
+ */
++ (NSArray *)fetchObjectIDsWithPredicate:(NSPredicate *)predicate inContext:(NSManagedObjectContext *)context options:(INFetchOptions *)options;
+
+/**
+ Fetches the objects of this entity matching a predicate as dictionaries.
+ 
+ Only the options' propertiesToFetch are fetched, or all properties if nil.
+ Pending changes of the context are never included in a dictionary result.
+ 
+ @param predicate The predicate the objects have to match. May be nil to fetch all.
+ @param context The context to fetch from.
+ @param options The options for the fetch request. May be nil.
+ @return The NSDictionary objects with the property names as keys.
+ */
++ (NSArray *)fetchDictionariesWithPredicate:(NSPredicate *)predicate inContext:(NSManagedObjectContext *)context options:(INFetchOptions *)options;
+
+
+/// @name Bulk import
+
+/**
+ Imports a large number of records as new objects of this entity on a background context.
+ 
+ A private queue context without undo manager is created for the coordinator and one new object is inserted per record.
+ The entity description is only looked up once for the whole import.
+ After each batch the context is saved and reset, so the memory used is bound by the batch size and not by the number of records.
+ Other contexts won't see the imported objects until they refetch or merge the context's save notifications.
+ 
+ Both blocks will be called on the main queue along with the throughput in records per second.
+ 
+    [Person importRecords:jsonPersons persistentStoreCoordinator:manager.persistentStoreCoordinator batchSize:0 configure:^(Person *person, NSDictionary *record) {
+        person.name = record[@"name"];
+    } progress:nil completion:^(NSUInteger importedCount, double recordsPerSecond, NSError *error) {
+        NSLog(@"Imported %lu persons with %.0f records/s", (unsigned long)importedCount, recordsPerSecond);
+    }];
+ 
+ @param records The records to import, i.e. dictionaries of a JSON response.
+ @param coordinator The coordinator of the store into which to import.
+ @param batchSize The number of objects to insert between two saves or 0 to use INManagedObjectImportDefaultBatchSize.
+ @param configureBlock The block which will be called on the import context's queue to fill a new object with the values of its record.
+ @param progressBlock The block which will be called after each saved batch with the number of records imported so far. May be nil.
+ @param completion The block which will be called when all records are imported or a save failed. May be nil.
+ */
++ (void)importRecords:(NSArray *)records persistentStoreCoordinator:(NSPersistentStoreCoordinator *)coordinator batchSize:(NSUInteger)batchSize configure:(void (^)(id object, id record))configureBlock progress:(void (^)(NSUInteger importedCount, double recordsPerSecond))progressBlock completion:(void (^)(NSUInteger importedCount, double recordsPerSecond, NSError *error))completion;
+
+
 @end
@@ -22,20 +22,36 @@
 
 
 #import "NSManagedObject+INExtensions.h"
+#import "INFetchOptions.h"
+#import <objc/runtime.h>
+
+
+// Key for the associated object holding the class' entity name.
+static const char *entityNameKey = "INExtensions_entityName";
 
 
 @implementation NSManagedObject (INExtensions)
 
 + (NSString *)entityName {
-    return NSStringFromClass([self class]);
+    NSString *entityName = objc_getAssociatedObject(self, entityNameKey);
+    if (entityName == nil) {
+        entityName = NSStringFromClass([self class]);
+        objc_setAssociatedObject(self, entityNameKey, entityName, OBJC_ASSOCIATION_COPY);
+    }
+    return entityName;
+}
+
++ (NSEntityDescription *)entityDescriptionInContext:(NSManagedObjectContext *)context {
+    // the model's entitiesByName lookup is already cheap, a cache in front of it would only add locking
+    return [NSEntityDescription entityForName:[self entityName] inManagedObjectContext:context];
 }
 
 + (instancetype)entityInContext:(NSManagedObjectContext *)context {
-    return [NSEntityDescription insertNewObjectForEntityForName:[self entityName] inManagedObjectContext:context];
+    return [[self alloc] initWithEntity:[self entityDescriptionInContext:context] insertIntoManagedObjectContext:context];
 }
 
 + (instancetype)disconnectedEntity:(NSManagedObjectContext *)context {
-	NSEntityDescription *entityDescription = [NSEntityDescription entityForName:[self entityName] inManagedObjectContext:context];
+	NSEntityDescription *entityDescription = [self entityDescriptionInContext:context];
 	return [[self alloc] initWithEntity:entityDescription insertIntoManagedObjectContext:nil];	
 }
 
@@ -44,4 +60,142 @@
 }
 
 
+#pragma mark - Fetching
+
++ (NSFetchRequest *)fetchRequestInContext:(NSManagedObjectContext *)context options:(INFetchOptions *)options {
+    NSFetchRequest *fetchRequest = [[NSFetchRequest alloc] init];
+    fetchRequest.entity = [self entityDescriptionInContext:context];
+    if (options == nil) {
+        options = [INFetchOptions options];
+    }
+    fetchRequest.fetchBatchSize = options.fetchBatchSize;
+    fetchRequest.fetchLimit = options.fetchLimit;
+    fetchRequest.fetchOffset = options.fetchOffset;
+    fetchRequest.sortDescriptors = options.sortDescriptors;
+    fetchRequest.relationshipKeyPathsForPrefetching = options.relationshipKeyPathsForPrefetching;
+    fetchRequest.propertiesToFetch = options.propertiesToFetch;
+    fetchRequest.returnsObjectsAsFaults = options.returnsObjectsAsFaults;
+    fetchRequest.includesPendingChanges = options.includesPendingChanges;
+    return fetchRequest;
+}
+
++ (NSPredicate *)predicateWithFormat:(NSString *)format substitutionVariables:(NSDictionary *)variables {
+    static NSCache *__predicateTemplates = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        __predicateTemplates = [[NSCache alloc] init];
+    });
+    
+    // parsing the format is the expensive part, so only do it once per format
+    NSPredicate *template = [__predicateTemplates objectForKey:format];
+    if (template == nil) {
+        template = [NSPredicate predicateWithFormat:format];
+        [__predicateTemplates setObject:template forKey:format];
+    }
+    return [template predicateWithSubstitutionVariables:(variables != nil) ? variables : @{}];
+}
+
++ (NSArray *)fetchAllInContext:(NSManagedObjectContext *)context options:(INFetchOptions *)options {
+    return [self fetchWithPredicate:nil inContext:context options:options];
+}
+
++ (NSArray *)fetchWithPredicate:(NSPredicate *)predicate inContext:(NSManagedObjectContext *)context options:(INFetchOptions *)options {
+    NSFetchRequest *fetchRequest = [self fetchRequestInContext:context options:options];
+    fetchRequest.predicate = predicate;
+    return [context executeFetchRequest:fetchRequest error:NULL];
+}
+
++ (NSArray *)fetchWithPredicateFormat:(NSString *)format substitutionVariables:(NSDictionary *)variables inContext:(NSManagedObjectContext *)context options:(INFetchOptions *)options {
+    NSPredicate *predicate = [self predicateWithFormat:format substitutionVariables:variables];
+    return [self fetchWithPredicate:predicate inContext:context options:options];
+}
+
++ (instancetype)fetchFirstWithPredicate:(NSPredicate *)predicate inContext:(NSManagedObjectContext *)context options:(INFetchOptions *)options {
+    NSFetchRequest *fetchRequest = [self fetchRequestInContext:context options:options];
+    fetchRequest.predicate = predicate;
+    fetchRequest.fetchLimit = 1;
+    fetchRequest.fetchBatchSize = 0;
+    NSArray *result = [context executeFetchRequest:fetchRequest error:NULL];
+    return (result.count > 0) ? result[0] : nil;
+}
+
++ (NSUInteger)countWithPredicate:(NSPredicate *)predicate inContext:(NSManagedObjectContext *)context {
+    NSFetchRequest *fetchRequest = [self fetchRequestInContext:context options:nil];
+    fetchRequest.predicate = predicate;
+    NSUInteger count = [context countForFetchRequest:fetchRequest error:NULL];
+    return (count != NSNotFound) ? count : 0;
+}
+
++ (NSArray *)fetchObjectIDsWithPredicate:(NSPredicate *)predicate inContext:(NSManagedObjectContext *)context options:(INFetchOptions *)options {
+    NSFetchRequest *fetchRequest = [self fetchRequestInContext:context options:options];
+    fetchRequest.predicate = predicate;
+    fetchRequest.resultType = NSManagedObjectIDResultType;
+    fetchRequest.includesPropertyValues = NO;
+    return [context executeFetchRequest:fetchRequest error:NULL];
+}
+
++ (NSArray *)fetchDictionariesWithPredicate:(NSPredicate *)predicate inContext:(NSManagedObjectContext *)context options:(INFetchOptions *)options {
+    NSFetchRequest *fetchRequest = [self fetchRequestInContext:context options:options];
+    fetchRequest.predicate = predicate;
+    fetchRequest.resultType = NSDictionaryResultType;
+    // pending changes are not supported with a dictionary result
+    fetchRequest.includesPendingChanges = NO;
+    return [context executeFetchRequest:fetchRequest error:NULL];
+}
+
+
+#pragma mark - Bulk import
+
++ (void)importRecords:(NSArray *)records persistentStoreCoordinator:(NSPersistentStoreCoordinator *)coordinator batchSize:(NSUInteger)batchSize configure:(void (^)(id object, id record))configureBlock progress:(void (^)(NSUInteger importedCount, double recordsPerSecond))progressBlock completion:(void (^)(NSUInteger importedCount, double recordsPerSecond, NSError *error))completion {
+    if (batchSize == 0) {
+        batchSize = INManagedObjectImportDefaultBatchSize;
+    }
+    
+    NSManagedObjectContext *context = [[NSManagedObjectContext alloc] initWithConcurrencyType:NSPrivateQueueConcurrencyType];
+    context.persistentStoreCoordinator = coordinator;
+    context.undoManager = nil;
+    
+    [context performBlock:^{
+        // the entity belongs to the model and stays valid when the context is reset
+        NSEntityDescription *entity = [self entityDescriptionInContext:context];
+        CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+        NSUInteger importedCount = 0;
+        NSError *error = nil;
+        
+        NSUInteger recordCount = records.count;
+        for (NSUInteger batchStart = 0; batchStart < recordCount && error == nil; batchStart += batchSize) {
+            @autoreleasepool {
+                NSUInteger batchEnd = MIN(batchStart + batchSize, recordCount);
+                for (NSUInteger i = batchStart; i < batchEnd; ++i) {
+                    NSManagedObject *object = [[self alloc] initWithEntity:entity insertIntoManagedObjectContext:context];
+                    if (configureBlock != nil) {
+                        configureBlock(object, records[i]);
+                    }
+                }
+                if (![context save:&error]) {
+                    break;
+                }
+                [context reset];
+                importedCount = batchEnd;
+            }
+            
+            if (progressBlock != nil) {
+                NSUInteger count = importedCount;
+                double recordsPerSecond = count / MAX(CFAbsoluteTimeGetCurrent() - startTime, DBL_EPSILON);
+                dispatch_async(dispatch_get_main_queue(), ^{
+                    progressBlock(count, recordsPerSecond);
+                });
+            }
+        }
+        
+        if (completion != nil) {
+            double recordsPerSecond = importedCount / MAX(CFAbsoluteTimeGetCurrent() - startTime, DBL_EPSILON);
+            dispatch_async(dispatch_get_main_queue(), ^{
+                completion(importedCount, recordsPerSecond, error);
+            });
+        }
+    }];
+}
+
+
 @end
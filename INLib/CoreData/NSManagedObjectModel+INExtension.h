@@ -42,16 +42,28 @@ static NSInteger const INManagedObjectModelVersionNone = 0;
 + (instancetype)modelNamed:(NSString *)modelName;
 
 /**
- Class method for creating a managed object model with a specific version number.
+ Class method for returning the managed object model with a specific version number.
  
  The different mode versions (xcdatamodel file names) have to be named 'ModelName_X' where X is the version number.
  
  @param modelName The name of the model in general without any version number.
  @param versionNumber A positive number beginning with 1 for the initial version.
- @return A new managed object model instance.
+ @return A new model instance or nil if there is no such version.
 */
 + (instancetype)modelNamed:(NSString *)modelName version:(NSInteger)versionNumber;
 
+/**
+ Class method for returning a shared managed object model with a specific version number.
+ 
+ Same as modelNamed:version:, but the model is loaded only once and then shared by all callers, including the migration of INCoreDataManager.
+ The returned model must not be modified, use modelNamed:version: for getting a model which may be changed.
+ 
+ @param modelName The name of the model in general without any version number.
+ @param versionNumber A positive number beginning with 1 for the initial version.
+ @return The shared model instance or nil if there is no such version.
+ */
++ (instancetype)sharedModelNamed:(NSString *)modelName version:(NSInteger)versionNumber;
+
 
 /// @name Comparision
 
@@ -68,14 +80,52 @@ static NSInteger const INManagedObjectModelVersionNone = 0;
 /**
  Returns true if the given SQLite store can be opened with this model.
  
+ Only the store's metadata will be read and compared with the model's entity version hashes, which are computed once per model.
+ If the metadata can't be read the store will be opened to check the compatibility.
+ 
  @param storeUrl The URL to a SQLite store.
  @return True if the model and store are compatible, otherwise false.
 */
 - (BOOL)isCompatibleWithStoreAtUrl:(NSURL *)storeUrl;
 
+/**
+ Returns true if the given SQLite store can be opened with this model and the given store options.
+ 
+ This method does the same as isCompatibleWithStoreAtUrl: except that the options are used when the store has to be opened.
+ 
+ @param storeUrl The URL to a SQLite store.
+ @param options The options to open the store with, i.e. of a INCoreDataStoreConfiguration. May be nil.
+ @return True if the model and store are compatible, otherwise false.
+ @see isCompatibleWithStoreAtUrl:
+ */
+- (BOOL)isCompatibleWithStoreAtUrl:(NSURL *)storeUrl options:(NSDictionary *)options;
+
+/**
+ Returns true if a store with the given metadata can be opened with this model.
+ 
+ Compares the store's entity version hashes with those of the model, which are computed once per model.
+ 
+ @param metadata The store's metadata, i.e. returned by metadataForStoreAtUrl:.
+ @return True if the model and store are compatible, otherwise false.
+ */
+- (BOOL)isCompatibleWithStoreMetadata:(NSDictionary *)metadata;
+
+/**
+ Reads the metadata of a SQLite store without opening the store.
+ 
+ @param storeUrl The URL to a SQLite store.
+ @return The store's metadata or nil if there is no store or its metadata couldn't be read.
+ */
++ (NSDictionary *)metadataForStoreAtUrl:(NSURL *)storeUrl;
+
 
 /// @name Model version
 
+// The model versions are looked up once per model name and kept in a thread-safe catalog.
+// Each version's model file is only loaded when it is needed for the first time.
+// The versions are compared with stores and the current model by their entity version hashes,
+// which are read from the VersionInfo.plist Xcode writes into the compiled model, so no model file needs to be loaded for this.
+
 /**
  Returns an array of URLs to the different version files of one model.
  
@@ -97,9 +147,46 @@ static NSInteger const INManagedObjectModelVersionNone = 0;
 */
 + (NSInteger)versionNumberOfModelNamed:(NSString *)modelName forStoreAtUrl:(NSURL *)storeUrl;
 
+/**
+ Returns the version number of the model which can manage a specific store opened with the given store options.
+ 
+ This method does the same as versionNumberOfModelNamed:forStoreAtUrl: except that the options are used when the store has to be opened.
+ 
+ @param modelName The name of the model.
+ @param storeUrl The URL to the SQLite store.
+ @param options The options to open the store with, i.e. of a INCoreDataStoreConfiguration. May be nil.
+ @return The version number (1 or greater) or INManagedObjectModelVersionNone (0) if no compatible model with the propper naming convention could be found.
+ @see versionNumberOfModelNamed:forStoreAtUrl:
+ */
++ (NSInteger)versionNumberOfModelNamed:(NSString *)modelName forStoreAtUrl:(NSURL *)storeUrl options:(NSDictionary *)options;
+
+/**
+ Returns the version number of the model which can manage a store with the given metadata.
+ 
+ May be used for stores without a file, i.e. in-memory stores, by passing the metadata returned by their coordinator.
+ 
+ @param modelName The name of the model.
+ @param metadata The store's metadata.
+ @return The version number (1 or greater) or INManagedObjectModelVersionNone (0) if no compatible model with the propper naming convention could be found.
+ */
++ (NSInteger)versionNumberOfModelNamed:(NSString *)modelName forStoreMetadata:(NSDictionary *)metadata;
+
+/**
+ Returns the entity version hashes of a model version, which identify the version.
+ 
+ The hashes are read from the compiled model's version info file if possible, otherwise the model version is loaded to get them.
+ 
+ @param modelName The name of the model.
+ @param versionNumber The version number, 1 or greater.
+ @return The hashes by entity name or nil if there is no such version.
+ */
++ (NSDictionary *)entityVersionHashesOfModelNamed:(NSString *)modelName version:(NSInteger)versionNumber;
+
 /**
  Returns the current version number of the given model.
  
+ The version is taken from the compiled model's version info file if possible,
+ otherwise it is found by comparing the entity version hashes of the current model with those of each version. It is only determined once.
  The model version names (xcdatamodel file names) have to be of the type 'ModelName_X' with X is the version number.
  
  @param modelName The name of the model.
@@ -22,6 +22,186 @@
 
 
 #import "NSManagedObjectModel+INExtension.h"
+#import <objc/runtime.h>
+
+
+// Key for the associated object holding the model's cached entity version hashes.
+static const char *entityVersionHashesKey = "INExtension_entityVersionHashes";
+
+
+@interface NSManagedObjectModel (INExtensionPrivate)
+
+- (NSDictionary *)cachedEntityVersionHashes;
+
+@end
+
+
+#pragma mark - Model version catalog
+
+// The keys of the version info file Xcode puts into each compiled model directory.
+static NSString *const INModelVersionInfoFileName = @"VersionInfo";
+static NSString *const INModelVersionInfoHashesKey = @"NSManagedObjectModel_VersionHashes";
+static NSString *const INModelVersionInfoCurrentVersionKey = @"NSManagedObjectModel_CurrentVersionName";
+
+
+/// One version of a model inside a version catalog.
+/// The model file is only loaded when the model is needed or its fingerprint, the entity version hashes, couldn't be read from the version info file.
+@interface INManagedObjectModelVersion : NSObject
+
+@property (nonatomic, assign, readonly) NSInteger versionNumber;
+@property (nonatomic, strong, readonly) NSURL *url;
+@property (nonatomic, strong, readonly) NSManagedObjectModel *model;
+@property (nonatomic, strong, readonly) NSDictionary *entityVersionHashes;
+
+- (instancetype)initWithVersionNumber:(NSInteger)versionNumber url:(NSURL *)url entityVersionHashes:(NSDictionary *)entityVersionHashes;
+
+@end
+
+
+@implementation INManagedObjectModelVersion {
+    NSManagedObjectModel *_model;
+}
+
+- (instancetype)initWithVersionNumber:(NSInteger)versionNumber url:(NSURL *)url entityVersionHashes:(NSDictionary *)entityVersionHashes {
+    self = [super init];
+    if (self == nil) return self;
+    
+    _versionNumber = versionNumber;
+    _url = url;
+    _entityVersionHashes = entityVersionHashes;
+    
+    return self;
+}
+
+- (NSManagedObjectModel *)model {
+    @synchronized (self) {
+        if (_model == nil) {
+            _model = [[NSManagedObjectModel alloc] initWithContentsOfURL:self.url];
+        }
+        return _model;
+    }
+}
+
+- (NSDictionary *)entityVersionHashes {
+    if (_entityVersionHashes != nil) {
+        return _entityVersionHashes;
+    }
+    return [self.model cachedEntityVersionHashes];
+}
+
+@end
+
+
+/// All versions of one model, built once per model name by probing the bundle for 'ModelName_X.mom' files.
+@interface INManagedObjectModelCatalog : NSObject
+
+@property (nonatomic, strong, readonly) NSString *modelName;
+@property (nonatomic, strong, readonly) NSArray *versions;
+@property (nonatomic, assign, readonly) NSInteger currentVersionNumber;
+
++ (instancetype)catalogForModelName:(NSString *)modelName;
+- (INManagedObjectModelVersion *)versionWithNumber:(NSInteger)versionNumber;
+- (INManagedObjectModelVersion *)versionForStoreMetadata:(NSDictionary *)metadata;
+
+@end
+
+
+@implementation INManagedObjectModelCatalog {
+    NSNumber *_currentVersionNumber;
+}
+
++ (instancetype)catalogForModelName:(NSString *)modelName {
+    static NSMutableDictionary *__catalogs = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        __catalogs = [[NSMutableDictionary alloc] init];
+    });
+    
+    @synchronized (__catalogs) {
+        INManagedObjectModelCatalog *catalog = __catalogs[modelName];
+        if (catalog == nil) {
+            catalog = [[INManagedObjectModelCatalog alloc] initWithModelName:modelName];
+            __catalogs[modelName] = catalog;
+        }
+        return catalog;
+    }
+}
+
+- (instancetype)initWithModelName:(NSString *)modelName {
+    self = [super init];
+    if (self == nil) return self;
+    
+    _modelName = [modelName copy];
+    
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+    NSString *subdir = [NSString stringWithFormat:@"%@.momd", modelName];
+    
+    // The version info file contains the entity version hashes of each version, computed when compiling the model,
+    // so no model file needs to be loaded to compare a version with a store.
+    NSString *versionInfoPath = [[NSBundle mainBundle] pathForResource:INModelVersionInfoFileName ofType:@"plist" inDirectory:subdir];
+    NSDictionary *versionInfo = (versionInfoPath != nil) ? [NSDictionary dictionaryWithContentsOfFile:versionInfoPath] : nil;
+    NSDictionary *versionHashes = versionInfo[INModelVersionInfoHashesKey];
+    NSString *currentVersionName = versionInfo[INModelVersionInfoCurrentVersionKey];
+    
+    NSMutableArray *versions = [NSMutableArray array];
+    NSInteger versionNumber = INManagedObjectModelVersionNone;
+    while (true) {
+        NSString *fileName = [NSString stringWithFormat:@"%@_%ld", modelName, (long)(versionNumber + 1)];
+        NSString *filePath = [[NSBundle mainBundle] pathForResource:fileName ofType:@"mom" inDirectory:subdir];
+        if ([fileManager fileExistsAtPath:filePath]) {
+            versionNumber++;
+            NSDictionary *entityVersionHashes = versionHashes[fileName];
+            [versions addObject:[[INManagedObjectModelVersion alloc] initWithVersionNumber:versionNumber url:[NSURL fileURLWithPath:filePath] entityVersionHashes:entityVersionHashes]];
+            if ([fileName isEqualToString:currentVersionName]) {
+                _currentVersionNumber = @(versionNumber);
+            }
+        } else {
+            break;
+        }
+    }
+    _versions = [versions copy];
+    
+    return self;
+}
+
+- (INManagedObjectModelVersion *)versionWithNumber:(NSInteger)versionNumber {
+    if (versionNumber < 1 || versionNumber > (NSInteger)self.versions.count) {
+        return nil;
+    }
+    return self.versions[versionNumber - 1];
+}
+
+- (INManagedObjectModelVersion *)versionForStoreMetadata:(NSDictionary *)metadata {
+    NSDictionary *storeHashes = metadata[NSStoreModelVersionHashesKey];
+    if (storeHashes == nil) {
+        return nil;
+    }
+    for (INManagedObjectModelVersion *version in self.versions) {
+        if ([storeHashes isEqualToDictionary:version.entityVersionHashes]) {
+            return version;
+        }
+    }
+    return nil;
+}
+
+- (NSInteger)currentVersionNumber {
+    @synchronized (self) {
+        if (_currentVersionNumber == nil) {
+            NSDictionary *currentHashes = [[NSManagedObjectModel modelNamed:self.modelName] cachedEntityVersionHashes];
+            NSInteger currentVersionNumber = INManagedObjectModelVersionNone;
+            for (INManagedObjectModelVersion *version in self.versions) {
+                if ([version.entityVersionHashes isEqualToDictionary:currentHashes]) {
+                    currentVersionNumber = version.versionNumber;
+                    break;
+                }
+            }
+            _currentVersionNumber = @(currentVersionNumber);
+        }
+        return [_currentVersionNumber integerValue];
+    }
+}
+
+@end
 
 
 @implementation NSManagedObjectModel (INExtension)
@@ -34,11 +214,17 @@
 }
 
 + (instancetype)modelNamed:(NSString *)modelName version:(NSInteger)versionNumber {
-    NSString *subdir = [NSString stringWithFormat:@"%@.momd", modelName];
-    NSString *fileName = [NSString stringWithFormat:@"%@_%ld", modelName, (long)versionNumber];
-    NSURL *modelUrl = [[NSBundle mainBundle] URLForResource:fileName withExtension:@"mom" subdirectory:subdir];
-    NSManagedObjectModel *model = [[NSManagedObjectModel alloc] initWithContentsOfURL:modelUrl];
-    return model;
+    // the catalog only saves probing the bundle, the caller gets its own model which it may modify
+    NSURL *url = [[INManagedObjectModelCatalog catalogForModelName:modelName] versionWithNumber:versionNumber].url;
+    if (url == nil) {
+        return nil;
+    }
+    return [[NSManagedObjectModel alloc] initWithContentsOfURL:url];
+}
+
++ (instancetype)sharedModelNamed:(NSString *)modelName version:(NSInteger)versionNumber {
+    INManagedObjectModelCatalog *catalog = [INManagedObjectModelCatalog catalogForModelName:modelName];
+    return [catalog versionWithNumber:versionNumber].model;
 }
 
 
@@ -52,60 +238,84 @@
 }
 
 - (BOOL)isCompatibleWithStoreAtUrl:(NSURL *)storeUrl {
+    return [self isCompatibleWithStoreAtUrl:storeUrl options:nil];
+}
+
+- (BOOL)isCompatibleWithStoreAtUrl:(NSURL *)storeUrl options:(NSDictionary *)options {
+    NSDictionary *metadata = [NSManagedObjectModel metadataForStoreAtUrl:storeUrl];
+    if (metadata != nil) {
+        return [self isCompatibleWithStoreMetadata:metadata];
+    }
+    
+    // The metadata couldn't be read, i.e. because of a corrupted store, so fall back to try opening the store.
     NSPersistentStoreCoordinator *persistentStoreCoordinator = [[NSPersistentStoreCoordinator alloc] initWithManagedObjectModel:self];
-    return nil != [persistentStoreCoordinator addPersistentStoreWithType:NSSQLiteStoreType configuration:nil URL:storeUrl options:nil error:NULL];
+    return nil != [persistentStoreCoordinator addPersistentStoreWithType:NSSQLiteStoreType configuration:nil URL:storeUrl options:options error:NULL];
+}
+
+- (BOOL)isCompatibleWithStoreMetadata:(NSDictionary *)metadata {
+    NSDictionary *storeHashes = metadata[NSStoreModelVersionHashesKey];
+    if (storeHashes == nil) {
+        return NO;
+    }
+    return [storeHashes isEqualToDictionary:[self cachedEntityVersionHashes]];
+}
+
+- (NSDictionary *)cachedEntityVersionHashes {
+    // the model is immutable once in use, so its hashes only need to be computed once
+    NSDictionary *hashes = objc_getAssociatedObject(self, entityVersionHashesKey);
+    if (hashes == nil) {
+        hashes = [self.entityVersionHashesByName copy];
+        objc_setAssociatedObject(self, entityVersionHashesKey, hashes, OBJC_ASSOCIATION_RETAIN);
+    }
+    return hashes;
+}
+
++ (NSDictionary *)metadataForStoreAtUrl:(NSURL *)storeUrl {
+    if (storeUrl == nil || ![[NSFileManager defaultManager] fileExistsAtPath:storeUrl.path]) {
+        return nil;
+    }
+    return [NSPersistentStoreCoordinator metadataForPersistentStoreOfType:NSSQLiteStoreType URL:storeUrl error:NULL];
 }
 
 
 #pragma mark - Model version
 
 + (NSArray *)versionUrlsForModelName:(NSString *)modelName {
-    NSFileManager *fileManager = [NSFileManager defaultManager];
-    NSString *subdir = [NSString stringWithFormat:@"%@.momd", modelName];
-    NSMutableArray *versionUrls = [NSMutableArray array];
-    NSInteger versionNumber = INManagedObjectModelVersionNone;
-    while (true) {
-        NSString *fileName = [NSString stringWithFormat:@"%@_%ld", modelName, (long)(versionNumber + 1)];
-        NSString *filePath = [[NSBundle mainBundle] pathForResource:fileName ofType:@"mom" inDirectory:subdir];
-        if ([fileManager fileExistsAtPath:filePath]) {
-            versionNumber++;
-            [versionUrls addObject:[NSURL fileURLWithPath:filePath]];
-        } else {
-            break;
-        }
-    }
-    return versionUrls;
+    NSArray *versions = [INManagedObjectModelCatalog catalogForModelName:modelName].versions;
+    return [versions valueForKey:@"url"];
 }
 
 + (NSInteger)versionNumberOfModelNamed:(NSString *)modelName forStoreAtUrl:(NSURL *)storeUrl {
-    NSArray *versionUrls = [self versionUrlsForModelName:modelName];
-    for (NSURL *modelUrl in versionUrls) {
-        NSManagedObjectModel *model = [[NSManagedObjectModel alloc] initWithContentsOfURL:modelUrl];
-        if ([model isCompatibleWithStoreAtUrl:storeUrl]) {
-            NSArray *pathComponents = modelUrl.pathComponents;
-            NSString *fileName = [[pathComponents lastObject] stringByDeletingPathExtension];
-            NSArray *fileComponents = [fileName componentsSeparatedByString:@"_"];
-            NSString *version = [fileComponents lastObject];
-            return [version integerValue];
+    return [self versionNumberOfModelNamed:modelName forStoreAtUrl:storeUrl options:nil];
+}
+
++ (NSInteger)versionNumberOfModelNamed:(NSString *)modelName forStoreAtUrl:(NSURL *)storeUrl options:(NSDictionary *)options {
+    // read the store's metadata only once and compare it with each version instead of opening the store for each one
+    NSDictionary *metadata = [self metadataForStoreAtUrl:storeUrl];
+    INManagedObjectModelCatalog *catalog = [INManagedObjectModelCatalog catalogForModelName:modelName];
+    if (metadata != nil) {
+        INManagedObjectModelVersion *version = [catalog versionForStoreMetadata:metadata];
+        return (version != nil) ? version.versionNumber : INManagedObjectModelVersionNone;
+    }
+    for (INManagedObjectModelVersion *version in catalog.versions) {
+        if ([version.model isCompatibleWithStoreAtUrl:storeUrl options:options]) {
+            return version.versionNumber;
         }
     }
     return INManagedObjectModelVersionNone;
 }
 
++ (NSInteger)versionNumberOfModelNamed:(NSString *)modelName forStoreMetadata:(NSDictionary *)metadata {
+    INManagedObjectModelVersion *version = [[INManagedObjectModelCatalog catalogForModelName:modelName] versionForStoreMetadata:metadata];
+    return (version != nil) ? version.versionNumber : INManagedObjectModelVersionNone;
+}
+
++ (NSDictionary *)entityVersionHashesOfModelNamed:(NSString *)modelName version:(NSInteger)versionNumber {
+    return [[INManagedObjectModelCatalog catalogForModelName:modelName] versionWithNumber:versionNumber].entityVersionHashes;
+}
+
 + (NSInteger)versionNumberOfModelNamed:(NSString *)modelName {
-    NSManagedObjectModel *targetModel = [self modelNamed:modelName];
-    NSArray *versionUrls = [self versionUrlsForModelName:modelName];
-    for (NSURL *modelUrl in versionUrls) {
-        NSManagedObjectModel *versionModel = [[NSManagedObjectModel alloc] initWithContentsOfURL:modelUrl];
-        if ([versionModel isEqualToModel:targetModel]) {
-            NSArray *pathComponents = modelUrl.pathComponents;
-            NSString *fileName = [[pathComponents lastObject] stringByDeletingPathExtension];
-            NSArray *fileComponents = [fileName componentsSeparatedByString:@"_"];
-            NSString *version = [fileComponents lastObject];
-            return [version integerValue];
-        }
-    }
-    return INManagedObjectModelVersionNone;
+    return [INManagedObjectModelCatalog catalogForModelName:modelName].currentVersionNumber;
 }
 
 
@@ -0,0 +1,99 @@
+// main.m
+//
+// Copyright (c) 2014 Sven Korset
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+// Command line tool which compiles Localizable.strings files into the binary format read by INCompiledStringsTable.
+//
+// Build it on the Mac with:
+//
+//    clang -fobjc-arc -framework Foundation -I ../../INLib/Classes main.m ../../INLib/Classes/INCompiledStringsTable.m -o inlstrings
+//
+// Usage:
+//
+//    inlstrings <input.strings> <output.inlstrings>
+//    inlstrings <directory>
+//
+// When called with a directory each Localizable.strings in the directory's lproj folders will be compiled
+// to a Localizable.inlstrings file next to it, which makes it usable in a "Run Script" build phase, i.e.
+//
+//    "${SRCROOT}/Tools/inlstrings/inlstrings" "${TARGET_BUILD_DIR}/${UNLOCALIZED_RESOURCES_FOLDER_PATH}"
+//
+// The strings files stay untouched and are used by INLocalizer as a fallback.
+
+
+#import <Foundation/Foundation.h>
+#import "INCompiledStringsTable.h"
+
+
+static BOOL compileFile(NSString *inputPath, NSString *outputPath) {
+    NSDictionary *dictionary = [NSDictionary dictionaryWithContentsOfFile:inputPath];
+    if (dictionary == nil) {
+        fprintf(stderr, "inlstrings: could not read strings file %s\n", inputPath.fileSystemRepresentation);
+        return NO;
+    }
+    NSData *data = [INCompiledStringsTable compiledDataWithDictionary:dictionary];
+    if (![data writeToFile:outputPath atomically:YES]) {
+        fprintf(stderr, "inlstrings: could not write %s\n", outputPath.fileSystemRepresentation);
+        return NO;
+    }
+    printf("inlstrings: compiled %lu entries into %s\n", (unsigned long)dictionary.count, outputPath.fileSystemRepresentation);
+    return YES;
+}
+
+static BOOL compileDirectory(NSString *directoryPath) {
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+    NSArray *files = [fileManager contentsOfDirectoryAtPath:directoryPath error:NULL];
+    if (files == nil) {
+        fprintf(stderr, "inlstrings: could not read directory %s\n", directoryPath.fileSystemRepresentation);
+        return NO;
+    }
+    BOOL success = YES;
+    for (NSString *file in files) {
+        if (![file.pathExtension isEqualToString:@"lproj"]) {
+            continue;
+        }
+        NSString *languagePath = [directoryPath stringByAppendingPathComponent:file];
+        NSString *inputPath = [languagePath stringByAppendingPathComponent:@"Localizable.strings"];
+        if (![fileManager fileExistsAtPath:inputPath]) {
+            continue;
+        }
+        NSString *outputPath = [[inputPath stringByDeletingPathExtension] stringByAppendingPathExtension:INCompiledStringsTableFileExtension];
+        success = compileFile(inputPath, outputPath) && success;
+    }
+    return success;
+}
+
+int main(int argc, const char *argv[]) {
+    @autoreleasepool {
+        if (argc == 2) {
+            NSString *directoryPath = [[NSFileManager defaultManager] stringWithFileSystemRepresentation:argv[1] length:strlen(argv[1])];
+            return compileDirectory(directoryPath) ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+        if (argc == 3) {
+            NSString *inputPath = [[NSFileManager defaultManager] stringWithFileSystemRepresentation:argv[1] length:strlen(argv[1])];
+            NSString *outputPath = [[NSFileManager defaultManager] stringWithFileSystemRepresentation:argv[2] length:strlen(argv[2])];
+            return compileFile(inputPath, outputPath) ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+        fprintf(stderr, "usage: inlstrings <input.strings> <output.inlstrings>\n       inlstrings <directory>\n");
+        return EXIT_FAILURE;
+    }
+}